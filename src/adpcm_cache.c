@@ -0,0 +1,179 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - adpcm_cache.c                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adpcm_cache.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+
+struct adpcm_cache_slot_t {
+    uint32_t hash;
+    uint8_t payload_size;  /* 0 for empty slots */
+    uint8_t count;
+    uint8_t payload[ADPCM_CACHE_PAYLOAD_SIZE];
+    int16_t last_samples[2];
+    int16_t book[16];
+    int16_t samples[ADPCM_CACHE_FRAME_SIZE];
+};
+
+
+/* local functions */
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    while (size != 0) {
+        hash = (hash ^ *bytes++) * 0x01000193;
+        --size;
+    }
+
+    return hash;
+}
+
+static bool cache_enabled(struct hle_t* hle)
+{
+    struct adpcm_cache_t* cache = &hle->adpcm_cache;
+    size_t count = 1;
+
+    /* the reference code paths must really decode frames */
+    if (hle->reference || cache->budget < sizeof(struct adpcm_cache_slot_t))
+        return false;
+
+    if (cache->slots != NULL)
+        return true;
+
+    while (2 * count * sizeof(struct adpcm_cache_slot_t) <= cache->budget)
+        count *= 2;
+
+    cache->slots = calloc(count, sizeof(struct adpcm_cache_slot_t));
+    if (cache->slots == NULL) {
+        HleErrorMessage(hle->user_defined,
+                "Can't allocate ADPCM cache, disabling it.");
+        cache->budget = 0;
+        return false;
+    }
+
+    cache->mask = count - 1;
+    return true;
+}
+
+static bool slot_matches(const struct adpcm_cache_slot_t* slot,
+                         const struct adpcm_cache_key_t* key, size_t count)
+{
+    return slot->hash == key->hash
+        && slot->payload_size == key->payload_size
+        && slot->count == count
+        && slot->last_samples[0] == key->last_samples[0]
+        && slot->last_samples[1] == key->last_samples[1]
+        && memcmp(slot->payload, key->payload, key->payload_size) == 0
+        && memcmp(slot->book, key->book, sizeof(slot->book)) == 0;
+}
+
+
+/* global functions */
+void adpcm_cache_key_init(struct adpcm_cache_key_t* key,
+                          const uint8_t* payload, size_t payload_size,
+                          const int16_t* book, const int16_t* last_samples)
+{
+    uint32_t hash = 0x811c9dc5;
+
+    key->payload = payload;
+    key->payload_size = payload_size;
+    key->book = book;
+    key->last_samples[0] = (last_samples != NULL) ? last_samples[0] : 0;
+    key->last_samples[1] = (last_samples != NULL) ? last_samples[1] : 0;
+
+    hash = fnv1a(hash, payload, payload_size);
+    hash = fnv1a(hash, book, 16 * sizeof(book[0]));
+    hash = fnv1a(hash, key->last_samples, sizeof(key->last_samples));
+
+    key->hash = hash;
+}
+
+bool adpcm_cache_lookup(struct hle_t* hle, const struct adpcm_cache_key_t* key,
+                        int16_t* dst, size_t count)
+{
+    struct adpcm_cache_t* cache = &hle->adpcm_cache;
+    const struct adpcm_cache_slot_t* slot;
+
+    if (!cache_enabled(hle))
+        return false;
+
+    slot = &cache->slots[key->hash & cache->mask];
+    if (!slot_matches(slot, key, count)) {
+        ++cache->misses;
+        return false;
+    }
+
+    memcpy(dst, slot->samples, count * sizeof(dst[0]));
+    ++cache->hits;
+    return true;
+}
+
+void adpcm_cache_store(struct hle_t* hle, const struct adpcm_cache_key_t* key,
+                       const int16_t* samples, size_t count)
+{
+    struct adpcm_cache_t* cache = &hle->adpcm_cache;
+    struct adpcm_cache_slot_t* slot;
+
+    if (!cache_enabled(hle)
+     || key->payload_size > ADPCM_CACHE_PAYLOAD_SIZE
+     || count > ADPCM_CACHE_FRAME_SIZE)
+        return;
+
+    slot = &cache->slots[key->hash & cache->mask];
+    slot->hash = key->hash;
+    slot->payload_size = (uint8_t)key->payload_size;
+    slot->count = (uint8_t)count;
+    slot->last_samples[0] = key->last_samples[0];
+    slot->last_samples[1] = key->last_samples[1];
+    memcpy(slot->payload, key->payload, key->payload_size);
+    memcpy(slot->book, key->book, sizeof(slot->book));
+    memcpy(slot->samples, samples, count * sizeof(samples[0]));
+}
+
+void adpcm_cache_prepare(struct hle_t* hle)
+{
+    cache_enabled(hle);
+}
+
+void adpcm_cache_release(struct hle_t* hle)
+{
+    struct adpcm_cache_t* cache = &hle->adpcm_cache;
+    uint64_t lookups = cache->hits + cache->misses;
+
+    if (lookups != 0) {
+        HleInfoMessage(hle->user_defined,
+                "ADPCM cache: %llu hits, %llu misses (%.1f%% hit rate)",
+                (unsigned long long)cache->hits, (unsigned long long)cache->misses,
+                100.0 * (double)cache->hits / (double)lookups);
+    }
+
+    free(cache->slots);
+
+    cache->slots = NULL;
+    cache->mask = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
@@ -0,0 +1,81 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - adpcm_cache.h                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ADPCM_CACHE_H
+#define ADPCM_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct hle_t;
+
+enum { ADPCM_CACHE_PAYLOAD_SIZE = 20 };
+enum { ADPCM_CACHE_FRAME_SIZE = 32 };
+
+struct adpcm_cache_slot_t;
+
+/* Cache of decoded ADPCM frames, for instruments looping over the same
+ * samples every audio task. Keys are exact, so a hit gives the samples a
+ * decode would have given. */
+struct adpcm_cache_t {
+    /* memory budget in bytes (0 disables the cache) */
+    size_t budget;
+
+    /* lazily allocated direct mapped slots, a power of 2 of them */
+    struct adpcm_cache_slot_t* slots;
+    size_t mask;
+
+    /* statistics */
+    uint64_t hits;
+    uint64_t misses;
+};
+
+/* everything a frame decode depends on: its compressed bytes (header
+ * included), the codebook entry it selects and the last 2 samples of the
+ * previous frame */
+struct adpcm_cache_key_t {
+    const uint8_t* payload;
+    size_t payload_size;
+    const int16_t* book;
+    int16_t last_samples[2];
+    uint32_t hash;
+};
+
+void adpcm_cache_key_init(struct adpcm_cache_key_t* key,
+                          const uint8_t* payload, size_t payload_size,
+                          const int16_t* book, const int16_t* last_samples);
+
+/* copy the count decoded samples of key into dst and return true on a hit */
+bool adpcm_cache_lookup(struct hle_t* hle, const struct adpcm_cache_key_t* key,
+                        int16_t* dst, size_t count);
+
+void adpcm_cache_store(struct hle_t* hle, const struct adpcm_cache_key_t* key,
+                       const int16_t* samples, size_t count);
+
+/* allocate the cache ahead of lookups and stores, for the ones running on
+ * worker threads: an allocation failure can then be reported by the core
+ * thread */
+void adpcm_cache_prepare(struct hle_t* hle);
+
+void adpcm_cache_release(struct hle_t* hle);
+
+#endif
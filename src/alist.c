@@ -29,10 +29,17 @@
 #include "alist.h"
 #include "arithmetics.h"
 #include "audio.h"
+#include "audio_kernels.h"
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
 
+enum { RESAMPLE_BLOCK = 16 };
+enum { RESAMPLE_CHUNK = 64 };
+enum { ENVMIX_BLOCK = 64 };
+enum { IIRF_CHUNK = 64 };
+enum { NEAD_INAUDIBLE_GAIN = 0x20 }; /* -66dB */
+
 struct ramp_t
 {
     int64_t value;
@@ -40,6 +47,18 @@ struct ramp_t
     int64_t target;
 };
 
+/* buses of the envmixer commands (0:dry left, 1:dry right, 2:wet left,
+ * 3:wet right), only the first n of them being mixed */
+struct envmixer_t
+{
+    const struct audio_kernels_t* kernels;
+    const int16_t* in;
+    int16_t* buffers[4];
+    size_t n;
+    int16_t dry;
+    int16_t wet;
+};
+
 /* local functions */
 static void swap(int16_t **a, int16_t **b)
 {
@@ -96,6 +115,201 @@ static int16_t ramp_step(struct ramp_t* ramp)
     return (int16_t)(ramp->value >> 16);
 }
 
+static void envmixer_init(struct hle_t* hle, struct envmixer_t* env, size_t n,
+                          uint16_t dmem_dl, uint16_t dmem_dr,
+                          uint16_t dmem_wl, uint16_t dmem_wr,
+                          uint16_t dmemi, int16_t dry, int16_t wet)
+{
+    env->kernels    = audio_kernels(hle);
+    env->in         = (int16_t*)(hle->alist_buffer + dmemi);
+    env->buffers[0] = (int16_t*)(hle->alist_buffer + dmem_dl);
+    env->buffers[1] = (int16_t*)(hle->alist_buffer + dmem_dr);
+    env->buffers[2] = (int16_t*)(hle->alist_buffer + dmem_wl);
+    env->buffers[3] = (int16_t*)(hle->alist_buffer + dmem_wr);
+    env->n          = n;
+    env->dry        = dry;
+    env->wet        = wet;
+}
+
+/* exponential ramps get a new step every 8 samples */
+static void envmix_exp_steps(struct ramp_t* ramps, int32_t* exp_seq, const int32_t* exp_rates)
+{
+    unsigned i;
+
+    for (i = 0; i < 2; ++i) {
+        if (ramps[i].step != 0)
+        {
+            exp_seq[i] = ((int64_t)exp_seq[i]*(int64_t)exp_rates[i]) >> 16;
+            ramps[i].step = (exp_seq[i] - ramps[i].value) >> 3;
+        }
+    }
+}
+
+/* true if ramp_step will keep returning the same volume */
+static bool ramp_constant(const struct ramp_t* ramp)
+{
+    return ramp->step == 0 && ramp->value >= ramp->target;
+}
+
+static void envmix_gains(const struct envmixer_t* env, int16_t* gains,
+                         int16_t l_vol, int16_t r_vol)
+{
+    gains[0] = clamp_s16((l_vol * env->dry + 0x4000) >> 15);
+    gains[1] = clamp_s16((r_vol * env->dry + 0x4000) >> 15);
+    gains[2] = clamp_s16((l_vol * env->wet + 0x4000) >> 15);
+    gains[3] = clamp_s16((r_vol * env->wet + 0x4000) >> 15);
+}
+
+/* the nead envmixer kernels process groups of 8 samples at once, which only
+ * matches the per-sample order if buffers either coincide or lie a group apart */
+static bool envmix_nead_apart(const int16_t* in, const int16_t* dl, const int16_t* dr,
+                              const int16_t* wl, const int16_t* wr)
+{
+    const int16_t* const ranges[5] = { in, dl, dr, wl, wr };
+    size_t i, j;
+
+    for (i = 0; i < 5; ++i) {
+        for (j = 0; j < i; ++j) {
+            if (ranges[i] != ranges[j]
+             && ranges[i] < ranges[j] + 8
+             && ranges[j] < ranges[i] + 8)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/* steps the ramps and mixes input sample k into the buses */
+static void envmix_sample(const struct envmixer_t* env, struct ramp_t* ramps, size_t k)
+{
+    int16_t  gains[4];
+    int16_t* buffers[4];
+    int16_t l_vol = ramp_step(&ramps[0]);
+    int16_t r_vol = ramp_step(&ramps[1]);
+    size_t i;
+
+    for (i = 0; i < 4; ++i)
+        buffers[i] = env->buffers[i] + (k^S);
+
+    envmix_gains(env, gains, l_vol, r_vol);
+    alist_envmix_mix(env->n, buffers, gains, env->in[k^S]);
+}
+
+/* Blocks of samples can be mixed one bus after the other, instead of one
+ * sample at a time into every bus, as long as no bus writes to a sample
+ * another bus or the input reads at a different position. */
+static bool envmix_overlap(const struct envmixer_t* env, size_t count)
+{
+    const int16_t* ranges[5];
+    size_t i, j;
+
+    ranges[0] = env->in;
+    for (i = 0; i < env->n; ++i)
+        ranges[i + 1] = env->buffers[i];
+
+    for (i = 0; i <= env->n; ++i) {
+        for (j = 0; j < i; ++j) {
+            if (ranges[i] != ranges[j]
+             && ranges[i] < ranges[j] + count
+             && ranges[j] < ranges[i] + count)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/* steps the ramps over an even count of samples and stores their volumes
+ * in DMEM order (k^S), stopping early once both ramps are constant.
+ * Returns the number of samples stepped */
+static size_t envmix_ramps(struct ramp_t* ramps, int16_t* l_vols, int16_t* r_vols, size_t count)
+{
+    size_t k;
+
+    for (k = 0; k < count; ++k) {
+        if ((k & 1) == 0 && ramp_constant(&ramps[0]) && ramp_constant(&ramps[1]))
+            break;
+
+        l_vols[k^S] = ramp_step(&ramps[0]);
+        r_vols[k^S] = ramp_step(&ramps[1]);
+    }
+
+    return k;
+}
+
+/* mixes count (even) input samples from pos with per-sample volumes */
+static void envmix_block(const struct envmixer_t* env, size_t pos,
+                         const int16_t* l_vols, const int16_t* r_vols, size_t count)
+{
+    int16_t x[ENVMIX_BLOCK];
+    int16_t gains[ENVMIX_BLOCK];
+    size_t i;
+
+    /* the input may be one of the buses */
+    memcpy(x, env->in + pos, count * sizeof(x[0]));
+
+    for (i = 0; i < env->n; ++i) {
+        memset(gains, 0, count * sizeof(gains[0]));
+        env->kernels->mix_round(gains, (i & 1) ? r_vols : l_vols, count,
+                                (i < 2) ? env->dry : env->wet);
+        env->kernels->mix_gains(env->buffers[i] + pos, x, gains, count);
+    }
+}
+
+/* mixes count (even) input samples from pos once both ramps are constant */
+static void envmix_constant(const struct envmixer_t* env, const struct ramp_t* ramps,
+                            size_t pos, size_t count)
+{
+    int16_t x[ENVMIX_BLOCK];
+    int16_t gains[4];
+    size_t i;
+
+    envmix_gains(env, gains, (int16_t)(ramps[0].value >> 16), (int16_t)(ramps[1].value >> 16));
+
+    while (count != 0) {
+        size_t n = (count < ENVMIX_BLOCK) ? count : ENVMIX_BLOCK;
+
+        memcpy(x, env->in + pos, n * sizeof(x[0]));
+
+        for (i = 0; i < env->n; ++i)
+            env->kernels->mix(env->buffers[i] + pos, x, n, gains[i]);
+
+        pos   += n;
+        count -= n;
+    }
+}
+
+/* envmixing of count samples with steady ramps (envmix_ge, envmix_lin) */
+static void envmix_run(struct hle_t* hle, const struct envmixer_t* env,
+                       struct ramp_t* ramps, size_t count)
+{
+    int16_t l_vols[ENVMIX_BLOCK];
+    int16_t r_vols[ENVMIX_BLOCK];
+    size_t pos = 0;
+
+    if (!hle->reference && !envmix_overlap(env, count + 1)) {
+        const size_t even = count & ~(size_t)1;
+
+        while (pos < even) {
+            size_t n = envmix_ramps(ramps, l_vols, r_vols,
+                    (even - pos < ENVMIX_BLOCK) ? even - pos : ENVMIX_BLOCK);
+
+            if (n == 0) {
+                envmix_constant(env, ramps, pos, even - pos);
+                pos = even;
+                break;
+            }
+
+            envmix_block(env, pos, l_vols, r_vols, n);
+            pos += n;
+        }
+    }
+
+    for (; pos < count; ++pos)
+        envmix_sample(env, ramps, pos);
+}
+
 /* global functions */
 void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int abi_size)
 {
@@ -105,6 +319,11 @@ void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int
     const uint32_t *alist = dram_u32(hle, *dmem_u32(hle, TASK_DATA_PTR));
     const uint32_t *const alist_end = alist + (*dmem_u32(hle, TASK_DATA_SIZE) >> 2);
 
+    dram_trace_read(hle, *dmem_u32(hle, TASK_DATA_PTR) & 0xffffff,
+                    (*dmem_u32(hle, TASK_DATA_SIZE) >> 2) * 4);
+
+    hle->audio_tap.has_output = false;
+
     while (alist != alist_end) {
         w1 = *(alist++);
         w2 = *(alist++);
@@ -144,9 +363,33 @@ void alist_set_address(struct hle_t* hle, uint32_t so, uint32_t *segments, size_
     segments[segment] = offset;
 }
 
+/* Byte swizzling only permutes bytes within 32-bit words, so whole words of
+ * a DMEM range are where they would be without it, up to the end of DMEM */
+static uint16_t alist_words_span(uint16_t dmem, uint16_t count)
+{
+    uint16_t offset = dmem & 0xfff;
+    uint16_t size = count & ~3;
+
+    return (size < 0x1000 - offset) ? size : 0x1000 - offset;
+}
+
 void alist_clear(struct hle_t* hle, uint16_t dmem, uint16_t count)
 {
+    if (count >= 0x1000) {
+        memset(hle->alist_buffer, 0, 0x1000);
+        return;
+    }
+
     while(count != 0) {
+        if ((dmem & 3) == 0 && count >= 4) {
+            uint16_t n = alist_words_span(dmem, count);
+
+            memset(hle->alist_buffer + (dmem & 0xfff), 0, n);
+            dmem += n;
+            count -= n;
+            continue;
+        }
+
         *alist_u8(hle, dmem++) = 0;
         --count;
     }
@@ -158,6 +401,7 @@ void alist_load(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t cou
     dmem    &= ~3;
     address &= ~7;
     count = align(count, 8);
+    dram_trace_read(hle, address, count);
     memcpy(hle->alist_buffer + dmem, hle->dram + address, count);
 }
 
@@ -167,12 +411,34 @@ void alist_save(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t cou
     dmem    &= ~3;
     address &= ~7;
     count = align(count, 8);
+    dram_trace_write(hle, address, count, 4);
     memcpy(hle->dram + address, hle->alist_buffer + dmem, count);
+
+    audio_tap_save(hle, dmem, address, count);
 }
 
 void alist_move(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
 {
     while (count != 0) {
+        if (((dmemo | dmemi) & 3) == 0 && count >= 4) {
+            uint16_t o = dmemo & 0xfff;
+            uint16_t i = dmemi & 0xfff;
+            uint16_t n = alist_words_span(dmemo, count);
+
+            n = alist_words_span(dmemi, n);
+
+            /* bytes are moved forward, so a destination trailing its
+             * source repeats it: move one period at a time */
+            if (o > i && o - i < n)
+                n = o - i;
+
+            memmove(hle->alist_buffer + o, hle->alist_buffer + i, n);
+            dmemo += n;
+            dmemi += n;
+            count -= n;
+            continue;
+        }
+
         *alist_u8(hle, dmemo++) = *alist_u8(hle, dmemi++);
         --count;
     }
@@ -180,6 +446,19 @@ void alist_move(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t coun
 
 void alist_copy_every_other_sample(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
 {
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+
+    /* outputs never catch up with the inputs of a destination ahead of its
+     * source, so only wrapping or trailing destinations go sample by sample */
+    if (((dmemo | dmemi) & 3) == 0
+     && dmemo + 2 * count <= 0x1000
+     && dmemi + 4 * count <= 0x1000
+     && (dmemo <= dmemi || dmemo >= dmemi + 4 * count)) {
+        kernels->copy_every_other((int16_t*)(hle->alist_buffer + dmemo),
+                                  (const int16_t*)(hle->alist_buffer + dmemi), count);
+        return;
+    }
+
     while (count != 0) {
         *alist_s16(hle, dmemo) = *alist_s16(hle, dmemi);
         dmemo += 2;
@@ -223,33 +502,29 @@ void alist_copy_blocks(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16
     } while(block_left > 0);
 }
 
+static bool alist_ranges_overlap(uint16_t a, unsigned int na, uint16_t b, unsigned int nb)
+{
+    return a < b + nb && b < a + na;
+}
+
 void alist_interleave(struct hle_t* hle, uint16_t dmemo, uint16_t left, uint16_t right, uint16_t count)
 {
-    uint16_t       *dst  = (uint16_t*)(hle->alist_buffer + dmemo);
-    const uint16_t *srcL = (uint16_t*)(hle->alist_buffer + left);
-    const uint16_t *srcR = (uint16_t*)(hle->alist_buffer + right);
+    int16_t       *dst  = (int16_t*)(hle->alist_buffer + dmemo);
+    const int16_t *srcL = (int16_t*)(hle->alist_buffer + left);
+    const int16_t *srcR = (int16_t*)(hle->alist_buffer + right);
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
 
-    count >>= 2;
+    count &= ~3;
 
-    while(count != 0) {
-        uint16_t l1 = *(srcL++);
-        uint16_t l2 = *(srcL++);
-        uint16_t r1 = *(srcR++);
-        uint16_t r2 = *(srcR++);
-
-#ifdef M64P_BIG_ENDIAN
-        *(dst++) = l1;
-        *(dst++) = r1;
-        *(dst++) = l2;
-        *(dst++) = r2;
-#else
-        *(dst++) = r2;
-        *(dst++) = l2;
-        *(dst++) = r1;
-        *(dst++) = l1;
-#endif
-        --count;
-    }
+    audio_tap_interleave(hle, dmemo, 2 * count);
+
+    /* the scalar kernel is the historical loop, which gives the expected
+     * results for overlapping buffers */
+    if (alist_ranges_overlap(dmemo, 2 * count, left, count)
+     || alist_ranges_overlap(dmemo, 2 * count, right, count))
+        kernels = &audio_kernels_scalar;
+
+    kernels->interleave(dst, srcL, srcR, count >> 1);
 }
 
 
@@ -266,22 +541,19 @@ void alist_envmix_exp(
         const int32_t *rate,
         uint32_t address)
 {
-    size_t n = (aux) ? 4 : 2;
-
-    const int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
-    int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
-    int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
-    int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
-    int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
-
+    struct envmixer_t env;
     struct ramp_t ramps[2];
     int32_t exp_seq[2];
     int32_t exp_rates[2];
 
-    uint32_t ptr = 0;
+    int16_t l_vols[ENVMIX_BLOCK];
+    int16_t r_vols[ENVMIX_BLOCK];
+    size_t ptr = 0;
+    size_t samples;
     int x, y;
     short save_buffer[40];
 
+    dram_trace_read(hle, address, sizeof(save_buffer));
     memcpy((uint8_t *)save_buffer, (hle->dram + address), sizeof(save_buffer));
     if (init) {
         ramps[0].value  = (vol[0] << 16);
@@ -309,38 +581,43 @@ void alist_envmix_exp(
     ramps[0].step = ramps[0].target - ramps[0].value;
     ramps[1].step = ramps[1].target - ramps[1].value;
 
-    for (y = 0; y < count; y += 16) {
+    envmixer_init(hle, &env, aux ? 4 : 2, dmem_dl, dmem_dr, dmem_wl, dmem_wr, dmemi, dry, wet);
+    samples = ((count + 15) >> 4) << 3;
 
-        if (ramps[0].step != 0)
-        {
-            exp_seq[0] = ((int64_t)exp_seq[0]*(int64_t)exp_rates[0]) >> 16;
-            ramps[0].step = (exp_seq[0] - ramps[0].value) >> 3;
-        }
+    if (!hle->reference && !envmix_overlap(&env, samples)) {
+        /* ramps are stepped ahead in groups of 8 samples
+         * and mixed ENVMIX_BLOCK samples at once */
+        while (ptr < samples) {
+            size_t n = 0;
 
-        if (ramps[1].step != 0)
-        {
-            exp_seq[1] = ((int64_t)exp_seq[1]*(int64_t)exp_rates[1]) >> 16;
-            ramps[1].step = (exp_seq[1] - ramps[1].value) >> 3;
-        }
+            while (n < ENVMIX_BLOCK && ptr + n < samples) {
+                size_t stepped;
+
+                envmix_exp_steps(ramps, exp_seq, exp_rates);
+                stepped = envmix_ramps(ramps, l_vols + n, r_vols + n, 8);
+                n += stepped;
 
-        for (x = 0; x < 8; ++x) {
-            int16_t  gains[4];
-            int16_t* buffers[4];
-            int16_t l_vol = ramp_step(&ramps[0]);
-            int16_t r_vol = ramp_step(&ramps[1]);
+                if (stepped < 8)
+                    break;
+            }
 
-            buffers[0] = dl + (ptr^S);
-            buffers[1] = dr + (ptr^S);
-            buffers[2] = wl + (ptr^S);
-            buffers[3] = wr + (ptr^S);
+            if (n != 0)
+                envmix_block(&env, ptr, l_vols, r_vols, n);
+            ptr += n;
 
-            gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-            gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-            gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-            gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+            /* exp steps no longer update constant ramps */
+            if (ptr < samples && ramp_constant(&ramps[0]) && ramp_constant(&ramps[1])) {
+                envmix_constant(&env, ramps, ptr, samples - ptr);
+                ptr = samples;
+            }
+        }
+    }
+    else {
+        for (y = 0; y < count; y += 16) {
+            envmix_exp_steps(ramps, exp_seq, exp_rates);
 
-            alist_envmix_mix(n, buffers, gains, in[ptr^S]);
-            ++ptr;
+            for (x = 0; x < 8; ++x)
+                envmix_sample(&env, ramps, ptr++);
         }
     }
 
@@ -354,6 +631,7 @@ void alist_envmix_exp(
     *(int32_t *)(save_buffer + 14) = exp_seq[1];        /* 14-15 */
     *(int32_t *)(save_buffer + 16) = (int32_t)ramps[0].value;    /* 12-13 */
     *(int32_t *)(save_buffer + 18) = (int32_t)ramps[1].value;    /* 14-15 */
+    dram_trace_write(hle, address, sizeof(save_buffer), 4);
     memcpy(hle->dram + address, (uint8_t *)save_buffer, sizeof(save_buffer));
 }
 
@@ -370,18 +648,11 @@ void alist_envmix_ge(
         const int32_t *rate,
         uint32_t address)
 {
-    unsigned k;
-    size_t n = (aux) ? 4 : 2;
-
-    const int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
-    int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
-    int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
-    int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
-    int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
-
+    struct envmixer_t env;
     struct ramp_t ramps[2];
     short save_buffer[40];
 
+    dram_trace_read(hle, address, 80);
     memcpy((uint8_t *)save_buffer, (hle->dram + address), 80);
     if (init) {
         ramps[0].value  = (vol[0] << 16);
@@ -403,25 +674,8 @@ void alist_envmix_ge(
         ramps[1].value  = *(int32_t *)(save_buffer + 18);   /* 14-15 */
     }
 
-    count >>= 1;
-    for (k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(n, buffers, gains, in[k^S]);
-    }
+    envmixer_init(hle, &env, aux ? 4 : 2, dmem_dl, dmem_dr, dmem_wl, dmem_wr, dmemi, dry, wet);
+    envmix_run(hle, &env, ramps, count >> 1);
 
     *(int16_t *)(save_buffer +  0) = wet;               /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;               /* 2-3 */
@@ -433,6 +687,7 @@ void alist_envmix_ge(
     /**(int32_t *)(save_buffer + 14);*/                 /* 14-15 */
     *(int32_t *)(save_buffer + 16) = (int32_t)ramps[0].value;    /* 12-13 */
     *(int32_t *)(save_buffer + 18) = (int32_t)ramps[1].value;    /* 14-15 */
+    dram_trace_write(hle, address, 80, 4);
     memcpy(hle->dram + address, (uint8_t *)save_buffer, 80);
 }
 
@@ -448,16 +703,11 @@ void alist_envmix_lin(
         const int32_t *rate,
         uint32_t address)
 {
-    size_t k;
+    struct envmixer_t env;
     struct ramp_t ramps[2];
     int16_t save_buffer[40];
 
-    const int16_t * const in = (int16_t*)(hle->alist_buffer + dmemi);
-    int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
-    int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
-    int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
-    int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
-
+    dram_trace_read(hle, address, 80);
     memcpy((uint8_t *)save_buffer, hle->dram + address, 80);
     if (init) {
         ramps[0].step   = rate[0] / 8;
@@ -478,25 +728,8 @@ void alist_envmix_lin(
         ramps[1].value  = *(int32_t *)(save_buffer + 18); /* 16-17 */
     }
 
-    count >>= 1;
-    for(k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(4, buffers, gains, in[k^S]);
-    }
+    envmixer_init(hle, &env, 4, dmem_dl, dmem_dr, dmem_wl, dmem_wr, dmemi, dry, wet);
+    envmix_run(hle, &env, ramps, count >> 1);
 
     *(int16_t *)(save_buffer +  0) = wet;            /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;            /* 2-3 */
@@ -506,9 +739,31 @@ void alist_envmix_lin(
     *(int32_t *)(save_buffer + 10) = (int32_t)ramps[1].step;  /* 10-11 */
     *(int32_t *)(save_buffer + 16) = (int32_t)ramps[0].value; /* 16-17 */
     *(int32_t *)(save_buffer + 18) = (int32_t)ramps[1].value; /* 18-19 */
+    dram_trace_write(hle, address, 80, 4);
     memcpy(hle->dram + address, (uint8_t *)save_buffer, 80);
 }
 
+/* fast tier: a voice whose dry gains stay below NEAD_INAUDIBLE_GAIN
+ * over the whole buffer is inaudible, wet gains being applied on top of
+ * the dry ones */
+static bool envmix_nead_inaudible(const uint16_t* env_values, const uint16_t* env_steps,
+                                  unsigned count)
+{
+    unsigned k;
+
+    if (count == 0)
+        return false;
+
+    for (k = 0; k < 2; ++k) {
+        uint32_t last = env_values[k] + (uint32_t)env_steps[k] * (count / 8 - 1);
+
+        if (env_values[k] > NEAD_INAUDIBLE_GAIN || last > NEAD_INAUDIBLE_GAIN)
+            return false;
+    }
+
+    return true;
+}
+
 void alist_envmix_nead(
         struct hle_t* hle,
         bool swap_wet_LR,
@@ -534,6 +789,20 @@ void alist_envmix_nead(
     if (swap_wet_LR)
         swap(&wl, &wr);
 
+    if (hle_fast_audio(hle) && envmix_nead_inaudible(env_values, env_steps, count)) {
+        env_values[0] += env_steps[0] * (count / 8);
+        env_values[1] += env_steps[1] * (count / 8);
+        env_values[2] += env_steps[2] * (count / 8);
+        return;
+    }
+
+    if (!hle->reference && envmix_nead_apart(in, dl, dr, wl, wr)) {
+        int16_t* const buffers[4] = { dl, dr, wl, wr };
+
+        audio_kernels(hle)->envmix_nead(buffers, in, count, env_values, env_steps, xors);
+        return;
+    }
+
     while (count != 0) {
         size_t i;
         for(i = 0; i < 8; ++i) {
@@ -567,29 +836,14 @@ void alist_mix(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
     int16_t       *dst = (int16_t*)(hle->alist_buffer + dmemo);
     const int16_t *src = (int16_t*)(hle->alist_buffer + dmemi);
 
-    count >>= 1;
-
-    while(count != 0) {
-        sample_mix(dst, *src, gain);
-
-        ++dst;
-        ++src;
-        --count;
-    }
+    audio_kernels(hle)->mix(dst, src, count >> 1, gain);
 }
 
 void alist_multQ44(struct hle_t* hle, uint16_t dmem, uint16_t count, int8_t gain)
 {
     int16_t *dst = (int16_t*)(hle->alist_buffer + dmem);
 
-    count >>= 1;
-
-    while(count != 0) {
-        *dst = clamp_s16(*dst * gain >> 4);
-
-        ++dst;
-        --count;
-    }
+    audio_kernels(hle)->mult_q44(dst, count >> 1, gain);
 }
 
 void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
@@ -597,15 +851,7 @@ void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
     int16_t       *dst = (int16_t*)(hle->alist_buffer + dmemo);
     const int16_t *src = (int16_t*)(hle->alist_buffer + dmemi);
 
-    count >>= 1;
-
-    while(count != 0) {
-        *dst = clamp_s16(*dst + *src);
-
-        ++dst;
-        ++src;
-        --count;
-    }
+    audio_kernels(hle)->add(dst, src, count >> 1);
 }
 
 static void alist_resample_reset(struct hle_t* hle, uint16_t pos, uint32_t* pitch_accu)
@@ -620,6 +866,8 @@ static void alist_resample_reset(struct hle_t* hle, uint16_t pos, uint32_t* pitc
 
 static void alist_resample_load(struct hle_t* hle, uint32_t address, uint16_t pos, uint32_t* pitch_accu)
 {
+    dram_trace_read(hle, address & 0xffffff, 10);
+
     *sample(hle, pos + 0) = *dram_u16(hle, address + 0);
     *sample(hle, pos + 1) = *dram_u16(hle, address + 2);
     *sample(hle, pos + 2) = *dram_u16(hle, address + 4);
@@ -630,6 +878,8 @@ static void alist_resample_load(struct hle_t* hle, uint32_t address, uint16_t po
 
 static void alist_resample_save(struct hle_t* hle, uint32_t address, uint16_t pos, uint32_t pitch_accu)
 {
+    dram_trace_write(hle, address & 0xffffff, 10, 2);
+
     *dram_u16(hle, address + 0) = *sample(hle, pos + 0);
     *dram_u16(hle, address + 2) = *sample(hle, pos + 1);
     *dram_u16(hle, address + 4) = *sample(hle, pos + 2);
@@ -638,6 +888,138 @@ static void alist_resample_save(struct hle_t* hle, uint32_t address, uint16_t po
     *dram_u16(hle, address + 8) = pitch_accu;
 }
 
+static void resample_scalar(struct hle_t* hle, uint16_t* ipos, uint16_t* opos,
+                            uint32_t* pitch_accu, uint32_t pitch, unsigned int count)
+{
+    while (count != 0) {
+        const int16_t* lut = RESAMPLE_LUT + ((*pitch_accu & 0xfc00) >> 8);
+
+        *sample(hle, (*opos)++) = clamp_s16( (
+            (*sample(hle, *ipos    ) * lut[0]) +
+            (*sample(hle, *ipos + 1) * lut[1]) +
+            (*sample(hle, *ipos + 2) * lut[2]) +
+            (*sample(hle, *ipos + 3) * lut[3]) ) >> 15);
+
+        *pitch_accu += pitch;
+        *ipos += (*pitch_accu >> 16);
+        *pitch_accu &= 0xffff;
+        --count;
+    }
+}
+
+/* fast tier */
+static void resample_linear(struct hle_t* hle, uint16_t* ipos, uint16_t* opos,
+                            uint32_t* pitch_accu, uint32_t pitch, unsigned int count)
+{
+    while (count != 0) {
+        *sample(hle, (*opos)++) = resample_linear_sample(
+                *sample(hle, *ipos + 1), *sample(hle, *ipos + 2), *pitch_accu);
+
+        *pitch_accu += pitch;
+        *ipos += (*pitch_accu >> 16);
+        *pitch_accu &= 0xffff;
+        --count;
+    }
+}
+
+/* do [a, a+na) and [b, b+nb) intersect in the sample() ring ?
+ * ranges are widened by one sample to account for the S swizzle */
+static bool ring_overlap(uint16_t a, unsigned int na, uint16_t b, unsigned int nb)
+{
+    a -= 1; na += 2;
+    b -= 1; nb += 2;
+
+    return ((b - a) & 0xfff) < na || ((a - b) & 0xfff) < nb;
+}
+
+/* pitch is constant, so input positions and lut phases of a whole block of
+ * outputs are computed first, then gathered into 4-taps rows for the dot4
+ * kernel. Produces the same results as resample_scalar */
+static void resample_blocks(struct hle_t* hle, uint16_t* ipos, uint16_t* opos,
+                            uint32_t* pitch_accu, uint32_t pitch, unsigned int count)
+{
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+
+    while (count != 0) {
+        int16_t x[4 * RESAMPLE_BLOCK];
+        int16_t h[4 * RESAMPLE_BLOCK];
+        int16_t y[RESAMPLE_BLOCK];
+        uint16_t pos[RESAMPLE_BLOCK];
+        uint16_t phase[RESAMPLE_BLOCK];
+
+        unsigned int n = (count < RESAMPLE_BLOCK) ? count : RESAMPLE_BLOCK;
+        uint16_t next_ipos = *ipos;
+        uint32_t next_accu = *pitch_accu;
+        unsigned int i, k;
+
+        for (i = 0; i < n; ++i) {
+            pos[i] = next_ipos;
+            phase[i] = (next_accu & 0xfc00) >> 8;
+
+            next_accu += pitch;
+            next_ipos += (next_accu >> 16);
+            next_accu &= 0xffff;
+        }
+
+        /* outputs feeding inputs of the same block need the sequential loop */
+        if (ring_overlap(*ipos, (uint16_t)(pos[n - 1] - *ipos) + 4, *opos, n)) {
+            resample_scalar(hle, ipos, opos, pitch_accu, pitch, n);
+        }
+        else {
+            for (i = 0; i < n; ++i) {
+                memcpy(&h[4 * i], RESAMPLE_LUT + phase[i], 4 * sizeof(h[0]));
+
+                for (k = 0; k < 4; ++k)
+                    x[4 * i + k] = *sample(hle, pos[i] + k);
+            }
+
+            kernels->dot4(y, x, h, n);
+
+            for (i = 0; i < n; ++i)
+                *sample(hle, (*opos)++) = y[i];
+
+            *ipos = next_ipos;
+            *pitch_accu = next_accu;
+        }
+
+        count -= n;
+    }
+}
+
+/* at unity pitch the lut phase never changes and inputs are contiguous,
+ * so resampling reduces to a constant 4-taps FIR */
+static void resample_unity(struct hle_t* hle, uint16_t* ipos, uint16_t* opos,
+                           uint32_t pitch_accu, unsigned int count)
+{
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+    const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8);
+
+    while (count != 0) {
+        int16_t x[RESAMPLE_CHUNK + 3];
+        int16_t y[RESAMPLE_CHUNK];
+
+        unsigned int n = (count < RESAMPLE_CHUNK) ? count : RESAMPLE_CHUNK;
+        unsigned int i;
+
+        if (ring_overlap(*ipos, n + 3, *opos, n)) {
+            resample_scalar(hle, ipos, opos, &pitch_accu, 0x10000, n);
+        }
+        else {
+            for (i = 0; i < n + 3; ++i)
+                x[i] = *sample(hle, *ipos + i);
+
+            kernels->fir4(y, x, n, lut);
+
+            for (i = 0; i < n; ++i)
+                *sample(hle, (*opos)++) = y[i];
+
+            *ipos += n;
+        }
+
+        count -= n;
+    }
+}
+
 void alist_resample(
         struct hle_t* hle,
         bool init,
@@ -663,24 +1045,37 @@ void alist_resample(
     else
         alist_resample_load(hle, address, ipos, &pitch_accu);
 
-    while (count != 0) {
-        const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8);
-
-        *sample(hle, opos++) = clamp_s16( (
-            (*sample(hle, ipos    ) * lut[0]) +
-            (*sample(hle, ipos + 1) * lut[1]) +
-            (*sample(hle, ipos + 2) * lut[2]) +
-            (*sample(hle, ipos + 3) * lut[3]) ) >> 15);
-
-        pitch_accu += pitch;
-        ipos += (pitch_accu >> 16);
-        pitch_accu &= 0xffff;
-        --count;
-    }
+    if (hle->reference)
+        resample_scalar(hle, &ipos, &opos, &pitch_accu, pitch, count);
+    else if (hle_fast_audio(hle))
+        resample_linear(hle, &ipos, &opos, &pitch_accu, pitch, count);
+    else if (pitch == 0x10000)
+        resample_unity(hle, &ipos, &opos, pitch_accu, count);
+    else
+        resample_blocks(hle, &ipos, &opos, &pitch_accu, pitch, count);
 
     alist_resample_save(hle, address, ipos, pitch_accu);
 }
 
+/* copy count samples in one go when both ranges are pair aligned, do not
+ * wrap around the sample ring and do not overlap */
+static bool zoh_copy(struct hle_t* hle, uint16_t ipos, uint16_t opos, unsigned int count)
+{
+    ipos &= 0xfff;
+    opos &= 0xfff;
+
+    if (((ipos | opos | count) & 1) != 0
+     || ipos + count > 0x1000 || opos + count > 0x1000
+     || ring_overlap(ipos, count, opos, count))
+        return false;
+
+    /* pair aligned ranges are not affected by the S swizzle */
+    memcpy((int16_t*)hle->alist_buffer + opos,
+           (int16_t*)hle->alist_buffer + ipos,
+           count * sizeof(int16_t));
+    return true;
+}
+
 void alist_resample_zoh(
         struct hle_t* hle,
         uint16_t dmemo,
@@ -693,6 +1088,10 @@ void alist_resample_zoh(
     uint16_t opos = dmemo >> 1;
     count >>= 1;
 
+    /* at unity pitch, ZOH is a plain copy */
+    if (!hle->reference && pitch == 0x10000 && zoh_copy(hle, ipos, opos, count))
+        return;
+
     while(count != 0) {
 
         *sample(hle, opos++) = *sample(hle, ipos);
@@ -704,41 +1103,23 @@ void alist_resample_zoh(
     }
 }
 
-typedef unsigned int (*adpcm_predict_frame_t)(struct hle_t* hle,
-                                              int16_t* dst, uint16_t dmemi, unsigned char scale);
+typedef void (*adpcm_predict_frame_t)(const struct audio_kernels_t* kernels,
+                                      int16_t* dst, const uint8_t* bytes, unsigned char scale);
 
-static unsigned int adpcm_predict_frame_4bits(struct hle_t* hle,
-                                              int16_t* dst, uint16_t dmemi, unsigned char scale)
+static void adpcm_predict_frame_4bits(const struct audio_kernels_t* kernels,
+                                      int16_t* dst, const uint8_t* bytes, unsigned char scale)
 {
-    unsigned int i;
     unsigned int rshift = (scale < 12) ? 12 - scale : 0;
 
-    for(i = 0; i < 8; ++i) {
-        uint8_t byte = *alist_u8(hle, dmemi++);
-
-        *(dst++) = adpcm_predict_sample(byte, 0xf0,  8, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x0f, 12, rshift);
-    }
-
-    return 8;
+    kernels->adpcm_expand_4bits(dst, bytes, rshift);
 }
 
-static unsigned int adpcm_predict_frame_2bits(struct hle_t* hle,
-                                              int16_t* dst, uint16_t dmemi, unsigned char scale)
+static void adpcm_predict_frame_2bits(const struct audio_kernels_t* kernels,
+                                      int16_t* dst, const uint8_t* bytes, unsigned char scale)
 {
-    unsigned int i;
     unsigned int rshift = (scale < 14) ? 14 - scale : 0;
 
-    for(i = 0; i < 4; ++i) {
-        uint8_t byte = *alist_u8(hle, dmemi++);
-
-        *(dst++) = adpcm_predict_sample(byte, 0xc0,  8, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x30, 10, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x0c, 12, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x03, 14, rshift);
-    }
-
-    return 4;
+    kernels->adpcm_expand_2bits(dst, bytes, rshift);
 }
 
 void alist_adpcm(
@@ -750,9 +1131,11 @@ void alist_adpcm(
         uint16_t dmemi,
         uint16_t count,
         const int16_t* codebook,
+        struct adpcm_predictor_t* predictor,
         uint32_t loop_address,
         uint32_t last_frame_address)
 {
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
     int16_t last_frame[16];
     size_t i;
 
@@ -760,6 +1143,9 @@ void alist_adpcm(
         ? adpcm_predict_frame_2bits
         : adpcm_predict_frame_4bits;
 
+    /* header byte, then 16 samples of 4 or 2 bits */
+    const size_t frame_size = (two_bit_per_sample) ? 5 : 9;
+
     assert((count & 0x1f) == 0);
 
     if (init)
@@ -772,14 +1158,40 @@ void alist_adpcm(
 
     while (count != 0) {
         int16_t frame[16];
-        uint8_t code = *alist_u8(hle, dmemi++);
-        unsigned char scale = (code & 0xf0) >> 4;
-        const int16_t* const cb_entry = codebook + ((code & 0xf) << 4);
-
-        dmemi += predict_frame(hle, frame, dmemi, scale);
-
-        adpcm_compute_residuals(last_frame    , frame    , cb_entry, last_frame + 14, 8);
-        adpcm_compute_residuals(last_frame + 8, frame + 8, cb_entry, last_frame + 6 , 8);
+        uint8_t bytes[9];
+        uint8_t code;
+        unsigned char scale;
+        const int16_t* cb_entry;
+        const int16_t* matrix;
+        struct adpcm_cache_key_t key;
+
+        for(i = 0; i < frame_size; ++i)
+            bytes[i] = *alist_u8(hle, dmemi++);
+
+        code = bytes[0];
+        scale = (code & 0xf0) >> 4;
+        cb_entry = codebook + ((code & 0xf) << 4);
+
+        adpcm_cache_key_init(&key, bytes, frame_size, cb_entry, last_frame + 14);
+
+        if (!adpcm_cache_lookup(hle, &key, last_frame, 16)) {
+            matrix = (hle->reference)
+                ? NULL
+                : adpcm_predictor_matrix(predictor, codebook, code & 0xf);
+
+            predict_frame(kernels, frame, bytes + 1, scale);
+
+            if (matrix != NULL) {
+                kernels->adpcm_residuals(last_frame    , frame    , matrix, last_frame + 14, 8);
+                kernels->adpcm_residuals(last_frame + 8, frame + 8, matrix, last_frame + 6 , 8);
+            }
+            else {
+                adpcm_compute_residuals(last_frame    , frame    , cb_entry, last_frame + 14, 8);
+                adpcm_compute_residuals(last_frame + 8, frame + 8, cb_entry, last_frame + 6 , 8);
+            }
+
+            adpcm_cache_store(hle, &key, last_frame, 16);
+        }
 
         for(i = 0; i < 16; ++i, dmemo += 2)
             *alist_s16(hle, dmemo) = last_frame[i];
@@ -799,111 +1211,74 @@ void alist_filter(
         const uint32_t* lut_address)
 {
     int x;
-    int16_t outbuff[0x3c0];
-    int16_t *outp = outbuff;
+    int16_t history[8];
 
     int16_t* const lutt6 = (int16_t*)(hle->dram + lut_address[0]);
     int16_t* const lutt5 = (int16_t*)(hle->dram + lut_address[1]);
 
-    int16_t* in1 = (int16_t*)(hle->dram + address);
-    int16_t* in2 = (int16_t*)(hle->alist_buffer + dmem);
+    int16_t* samples = (int16_t*)(hle->alist_buffer + dmem);
 
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+    size_t blocks = count >> 4;
+    size_t rest   = count & 0xf;
+
+    dram_trace_read(hle, lut_address[0], 16);
+    dram_trace_read(hle, lut_address[1], 16);
+    dram_trace_write(hle, lut_address[0], 16, 4);
+    dram_trace_write(hle, lut_address[1], 16, 4);
 
     for (x = 0; x < 8; ++x) {
         int32_t v = (lutt5[x] + lutt6[x]) >> 1;
         lutt5[x] = lutt6[x] = v;
     }
 
-    for (x = 0; x < count; x += 16) {
-        int32_t v[8];
-
-        v[1] =  in1[0] * lutt6[6];
-        v[1] += in1[3] * lutt6[7];
-        v[1] += in1[2] * lutt6[4];
-        v[1] += in1[5] * lutt6[5];
-        v[1] += in1[4] * lutt6[2];
-        v[1] += in1[7] * lutt6[3];
-        v[1] += in1[6] * lutt6[0];
-        v[1] += in2[1] * lutt6[1]; /* 1 */
-
-        v[0] =  in1[3] * lutt6[6];
-        v[0] += in1[2] * lutt6[7];
-        v[0] += in1[5] * lutt6[4];
-        v[0] += in1[4] * lutt6[5];
-        v[0] += in1[7] * lutt6[2];
-        v[0] += in1[6] * lutt6[3];
-        v[0] += in2[1] * lutt6[0];
-        v[0] += in2[0] * lutt6[1];
-
-        v[3] =  in1[2] * lutt6[6];
-        v[3] += in1[5] * lutt6[7];
-        v[3] += in1[4] * lutt6[4];
-        v[3] += in1[7] * lutt6[5];
-        v[3] += in1[6] * lutt6[2];
-        v[3] += in2[1] * lutt6[3];
-        v[3] += in2[0] * lutt6[0];
-        v[3] += in2[3] * lutt6[1];
-
-        v[2] =  in1[5] * lutt6[6];
-        v[2] += in1[4] * lutt6[7];
-        v[2] += in1[7] * lutt6[4];
-        v[2] += in1[6] * lutt6[5];
-        v[2] += in2[1] * lutt6[2];
-        v[2] += in2[0] * lutt6[3];
-        v[2] += in2[3] * lutt6[0];
-        v[2] += in2[2] * lutt6[1];
-
-        v[5] =  in1[4] * lutt6[6];
-        v[5] += in1[7] * lutt6[7];
-        v[5] += in1[6] * lutt6[4];
-        v[5] += in2[1] * lutt6[5];
-        v[5] += in2[0] * lutt6[2];
-        v[5] += in2[3] * lutt6[3];
-        v[5] += in2[2] * lutt6[0];
-        v[5] += in2[5] * lutt6[1];
-
-        v[4] =  in1[7] * lutt6[6];
-        v[4] += in1[6] * lutt6[7];
-        v[4] += in2[1] * lutt6[4];
-        v[4] += in2[0] * lutt6[5];
-        v[4] += in2[3] * lutt6[2];
-        v[4] += in2[2] * lutt6[3];
-        v[4] += in2[5] * lutt6[0];
-        v[4] += in2[4] * lutt6[1];
-
-        v[7] =  in1[6] * lutt6[6];
-        v[7] += in2[1] * lutt6[7];
-        v[7] += in2[0] * lutt6[4];
-        v[7] += in2[3] * lutt6[5];
-        v[7] += in2[2] * lutt6[2];
-        v[7] += in2[5] * lutt6[3];
-        v[7] += in2[4] * lutt6[0];
-        v[7] += in2[7] * lutt6[1];
-
-        v[6] =  in2[1] * lutt6[6];
-        v[6] += in2[0] * lutt6[7];
-        v[6] += in2[3] * lutt6[4];
-        v[6] += in2[2] * lutt6[5];
-        v[6] += in2[5] * lutt6[2];
-        v[6] += in2[4] * lutt6[3];
-        v[6] += in2[7] * lutt6[0];
-        v[6] += in2[6] * lutt6[1];
-
-        outp[1] = ((v[1] + 0x4000) >> 15);
-        outp[0] = ((v[0] + 0x4000) >> 15);
-        outp[3] = ((v[3] + 0x4000) >> 15);
-        outp[2] = ((v[2] + 0x4000) >> 15);
-        outp[5] = ((v[5] + 0x4000) >> 15);
-        outp[4] = ((v[4] + 0x4000) >> 15);
-        outp[7] = ((v[7] + 0x4000) >> 15);
-        outp[6] = ((v[6] + 0x4000) >> 15);
-        in1 = in2;
-        in2 += 8;
-        outp += 8;
+    /* without any block, the saved history is the block preceding dmem */
+    if (count == 0) {
+        dram_trace_write(hle, address, 16, 4);
+        memcpy(hle->dram + address, samples - 8, 16);
+        return;
     }
 
-    memcpy(hle->dram + address, in2 - 8, 16);
-    memcpy(hle->alist_buffer + dmem, outbuff, count);
+    dram_trace_read(hle, address, 16);
+    memcpy(history, hle->dram + address, 16);
+
+    /* blocks are filtered in place, history keeping the last input block */
+    kernels->filter(samples, history, blocks, lutt6);
+
+    /* only the first rest bytes of a trailing partial block get written */
+    if (rest != 0) {
+        int16_t block[8];
+
+        memcpy(block, samples + 8 * blocks, 16);
+        kernels->filter(block, history, 1, lutt6);
+        memcpy(samples + 8 * blocks, block, rest);
+    }
+
+    dram_trace_write(hle, address, 16, 4);
+    memcpy(hle->dram + address, history, 16);
+}
+
+/* Each block of POLEF outputs is a linear map of the 2 last outputs and the
+ * 8 inputs of the block, stored like the ADPCM matrices (see audio.h).
+ * The gain, which lies on the diagonal, is stored as a signed value and
+ * compensated by the polef kernel */
+static void polef_matrix(int16_t* matrix, const int16_t* h1, const int16_t* h2_before,
+                         const int16_t* h2, uint16_t gain)
+{
+    unsigned i, j;
+
+    for(i = 0; i < 8; ++i) {
+        int16_t* row = matrix + 2*i;
+
+        row[0] = h1[i];
+        row[1] = h2_before[i];
+
+        /* frame[i] * gain, then rdot(i, h2, frame) */
+        for(j = 0; j < 8; ++j)
+            row[16 + 16*(j >> 1) + (j & 1)] = (j == i) ? (int16_t)gain
+                                            : (j < i)  ? h2[i - 1 - j]
+                                            : 0;
+    }
 }
 
 void alist_polef(
@@ -921,6 +1296,9 @@ void alist_polef(
     const int16_t* const h1 = table;
           int16_t* const h2 = table + 8;
 
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+    int16_t matrix[ADPCM_MATRIX_SIZE];
+
     unsigned i;
     int16_t l1, l2;
     int16_t h2_before[8];
@@ -932,6 +1310,7 @@ void alist_polef(
         l2 = 0;
     }
     else {
+        dram_trace_read(hle, (address + 4) & 0xffffff, 4);
         l1 = *dram_u16(hle, address + 4);
         l2 = *dram_u16(hle, address + 6);
     }
@@ -941,21 +1320,35 @@ void alist_polef(
         h2[i] = (((int32_t)h2[i] * gain) >> 14);
     }
 
+    if (!hle->reference)
+        polef_matrix(matrix, h1, h2_before, h2, gain);
+
     do
     {
         int16_t frame[8];
+        int16_t output[8];
 
         for(i = 0; i < 8; ++i, dmemi += 2)
             frame[i] = *alist_s16(hle, dmemi);
 
-        for(i = 0; i < 8; ++i) {
-            int32_t accu = frame[i] * gain;
-            accu += h1[i]*l1 + h2_before[i]*l2 + rdot(i, h2, frame);
-            dst[i^S] = clamp_s16(accu >> 14);
+        if (!hle->reference) {
+            const int16_t last_samples[2] = { l1, l2 };
+
+            kernels->polef(output, frame, matrix, last_samples, gain);
+        }
+        else {
+            for(i = 0; i < 8; ++i) {
+                int32_t accu = frame[i] * gain;
+                accu += h1[i]*l1 + h2_before[i]*l2 + rdot(i, h2, frame);
+                output[i] = clamp_s16(accu >> 14);
+            }
         }
 
-        l1 = dst[6^S];
-        l2 = dst[7^S];
+        for(i = 0; i < 8; ++i)
+            dst[i^S] = output[i];
+
+        l1 = output[6];
+        l2 = output[7];
 
         dst += 8;
         count -= 16;
@@ -964,6 +1357,83 @@ void alist_polef(
     dram_store_u32(hle, (uint32_t*)(dst - 4), address, 2);
 }
 
+/* The IIRF feedback goes through rounded vmulf products of the outputs and
+ * has to stay serial, but its FIR part only depends on the inputs and can be
+ * computed ahead for whole chunks, provided no output of a chunk overwrites
+ * one of its later inputs and the inputs do not wrap around DMEM */
+static bool iirf_blocks_apart(uint16_t dmemo, uint16_t dmemi, uint16_t count)
+{
+    if (count == 0 || dmemi + count > 0x1000)
+        return false;
+
+    /* unaligned samples are swizzled across pairs, so in place filtering
+     * needs aligned buffers and distinct buffers need some room */
+    return (dmemo == dmemi && (dmemo & 3) == 0)
+        || dmemo + count + 4 <= dmemi
+        || dmemi + count + 4 <= dmemo;
+}
+
+static void iirf_chunks(
+        struct hle_t* hle,
+        bool init,
+        int16_t* dst,
+        uint16_t dmemi,
+        uint16_t count,
+        const int16_t* table,
+        uint32_t address)
+{
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+    int16_t x[2 + IIRF_CHUNK];
+    int32_t fir[IIRF_CHUNK];
+    int16_t y[2];
+    int32_t prev;
+    size_t samples = count >> 1;
+
+    /* x holds the 2 inputs preceding the chunk, y the 2 last outputs */
+    if (init) {
+        x[0] = 0;
+        x[1] = 0;
+        y[0] = 0;
+        y[1] = 0;
+    }
+    else {
+        dram_trace_read(hle, (address + 4) & 0xffffff, 8);
+        y[0] = *dram_u16(hle, address + 4);
+        y[1] = *dram_u16(hle, address + 6);
+        x[0] = (int16_t)*dram_u16(hle, address + 8);
+        x[1] = (int16_t)*dram_u16(hle, address + 10);
+    }
+
+    prev = vmulf(table[9], y[0]) * 2;
+
+    while (samples != 0) {
+        size_t n = (samples < IIRF_CHUNK) ? samples : IIRF_CHUNK;
+        size_t k;
+
+        for (k = 0; k < n; ++k, dmemi += 2)
+            x[2 + k] = *alist_s16(hle, dmemi);
+
+        kernels->iirf_fir(fir, x, n, table[0], table[1]);
+
+        for (k = 0; k < n; ++k) {
+            int16_t output = prev + fir[k] + vmulf(table[8], y[1]) * 2;
+
+            prev = vmulf(table[9], y[1]) * 2;
+            dst[k^S] = output;
+            y[0] = y[1];
+            y[1] = output;
+        }
+
+        x[0] = x[n];
+        x[1] = x[n + 1];
+        dst += n;
+        samples -= n;
+    }
+
+    dram_store_u16(hle, (uint16_t*)y, address + 4, 2);
+    dram_store_u16(hle, (uint16_t*)x, address + 8, 2);
+}
+
 void alist_iirf(
         struct hle_t* hle,
         bool init,
@@ -982,6 +1452,11 @@ void alist_iirf(
 
     count = align(count, 16);
 
+    if (!hle->reference && iirf_blocks_apart(dmemo, dmemi, count)) {
+        iirf_chunks(hle, init, dst, dmemi, count, table, address);
+        return;
+    }
+
     if(init)
     {
         for(i = 0; i < 8; ++i)
@@ -991,6 +1466,7 @@ void alist_iirf(
     }
     else
     {
+        dram_trace_read(hle, (address + 4) & 0xffffff, 8);
         frame[6] = *dram_u16(hle, address + 4);
         frame[7] = *dram_u16(hle, address + 6);
         ibuf[1] = (int16_t)*dram_u16(hle, address + 8);
@@ -1025,14 +1501,8 @@ void alist_iirf(
 /* Perform a clamped gain, then attenuate it back by an amount */
 void alist_overload(struct hle_t* hle, uint16_t dmem, int16_t count, int16_t gain, uint16_t attenuation)
 {
-    int16_t accu;
     int16_t * sample = (int16_t*)(hle->alist_buffer + dmem);
 
-    while (count != 0)
-    {
-        accu = clamp_s16(*sample * gain);
-        *sample = (accu * attenuation) >> 16;
-        sample++;
-        count --;
-    }
+    /* a negative count used to wrap around, keep doing so */
+    audio_kernels(hle)->overload(sample, (uint16_t)count, gain, attenuation);
 }
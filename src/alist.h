@@ -27,6 +27,7 @@
 #include <stdint.h>
 
 struct hle_t;
+struct adpcm_predictor_t;
 
 typedef void (*acmd_callback_t)(struct hle_t* hle, uint32_t w1, uint32_t w2);
 
@@ -106,6 +107,7 @@ void alist_adpcm(
         uint16_t dmemi,
         uint16_t count,
         const int16_t* codebook,
+        struct adpcm_predictor_t* predictor,
         uint32_t loop_address,
         uint32_t last_frame_address);
 
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "alist.h"
+#include "audio.h"
 #include "common.h"
 #include "hle_internal.h"
 #include "memory.h"
@@ -159,6 +160,7 @@ static void ADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
             hle->alist_audio.in,
             align(hle->alist_audio.count, 32),
             hle->alist_audio.table,
+            &hle->alist_audio.predictor,
             hle->alist_audio.loop,
             address);
 }
@@ -216,6 +218,7 @@ static void LOADADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
     uint32_t address = get_address(hle, w2);
 
     dram_load_u16(hle, (uint16_t*)hle->alist_audio.table, address, align(count, 8) >> 1);
+    adpcm_predictor_load(&hle->alist_audio.predictor, hle->alist_audio.table);
 }
 
 static void INTERLEAVE(struct hle_t* hle, uint32_t UNUSED(w1), uint32_t w2)
@@ -264,6 +267,9 @@ static void POLEF(struct hle_t* hle, uint32_t w1, uint32_t w2)
             gain,
             hle->alist_audio.table,
             address);
+
+    /* polef scales the h2 coefficients of the table */
+    adpcm_predictor_invalidate(&hle->alist_audio.predictor);
 }
 
 /* global functions */
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include "alist.h"
+#include "audio.h"
 #include "common.h"
 #include "hle_external.h"
 #include "hle_internal.h"
@@ -89,6 +90,9 @@ static void NAUDIO_14(struct hle_t* hle, uint32_t w1, uint32_t w2)
                 gain,
                 hle->alist_naudio.table,
                 address);
+
+        /* polef scales the h2 coefficients of the table */
+        adpcm_predictor_invalidate(&hle->alist_naudio.predictor);
     }
     else
     {
@@ -190,6 +194,7 @@ static void LOADADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
     uint32_t address = (w2 & 0xffffff);
 
     dram_load_u16(hle, (uint16_t*)hle->alist_naudio.table, address, count >> 1);
+    adpcm_predictor_load(&hle->alist_naudio.predictor, hle->alist_naudio.table);
 }
 
 static void DMEMMOVE(struct hle_t* hle, uint32_t w1, uint32_t w2)
@@ -223,6 +228,7 @@ static void ADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
             dmemi,
             (count + 0x1f) & ~0x1f,
             hle->alist_naudio.table,
+            &hle->alist_naudio.predictor,
             hle->alist_naudio.loop,
             address);
 }
@@ -260,6 +266,8 @@ static void MP3(struct hle_t* hle, uint32_t w1, uint32_t w2)
     unsigned index = (w1 & 0x1e);
     uint32_t address = (w2 & 0xffffff);
 
+    /* mp3 DRAM accesses are not traced */
+    memo_poison(hle);
     mp3_task(hle, index, address);
 }
 
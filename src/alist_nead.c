@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include "alist.h"
+#include "audio.h"
 #include "common.h"
 #include "hle_external.h"
 #include "hle_internal.h"
@@ -57,6 +58,7 @@ static void LOADADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
     uint32_t address = (w2 & 0xffffff);
 
     dram_load_u16(hle, (uint16_t*)hle->alist_nead.table, address, count >> 1);
+    adpcm_predictor_load(&hle->alist_nead.predictor, hle->alist_nead.table);
 }
 
 static void SETLOOP(struct hle_t* hle, uint32_t UNUSED(w1), uint32_t w2)
@@ -85,6 +87,7 @@ static void ADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
             hle->alist_nead.in,
             (hle->alist_nead.count + 0x1f) & ~0x1f,
             hle->alist_nead.table,
+            &hle->alist_nead.predictor,
             hle->alist_nead.loop,
             address);
 }
@@ -355,6 +358,9 @@ static void POLEF(struct hle_t* hle, uint32_t w1, uint32_t w2)
             gain,
             hle->alist_nead.table,
             address);
+
+    /* polef scales the h2 coefficients of the table */
+    adpcm_predictor_invalidate(&hle->alist_nead.predictor);
 }
 
 
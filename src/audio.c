@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "arithmetics.h"
+#include "audio.h"
 
 const int16_t RESAMPLE_LUT[64 * 4] = {
     (int16_t)0x0c39, (int16_t)0x66ad, (int16_t)0x0d46, (int16_t)0xffdf,
@@ -126,3 +127,49 @@ void adpcm_compute_residuals(int16_t* dst, const int16_t* src,
    }
 }
 
+
+void adpcm_compute_matrix(int16_t* matrix, const int16_t* cb_entry)
+{
+    const int16_t* const book1 = cb_entry;
+    const int16_t* const book2 = cb_entry + 8;
+
+    size_t i, j;
+
+    for(i = 0; i < 8; ++i) {
+        int16_t* row = matrix + 2*i;
+
+        row[0] = book1[i];
+        row[1] = book2[i];
+
+        /* src[i] << 11, then rdot(i, book2, src) */
+        for(j = 0; j < 8; ++j)
+            row[16 + 16*(j >> 1) + (j & 1)] = (j == i) ? 2048
+                                            : (j < i)  ? book2[i - 1 - j]
+                                            : 0;
+    }
+}
+
+void adpcm_predictor_load(struct adpcm_predictor_t* predictor, const int16_t* table)
+{
+    unsigned entry;
+
+    for(entry = 0; entry < ADPCM_PREDICTOR_ENTRIES; ++entry)
+        adpcm_compute_matrix(predictor->matrices[entry], table + 16*entry);
+
+    predictor->valid = (1 << ADPCM_PREDICTOR_ENTRIES) - 1;
+}
+
+/* returns NULL for entries lying outside of the table */
+const int16_t* adpcm_predictor_matrix(struct adpcm_predictor_t* predictor,
+        const int16_t* table, unsigned entry)
+{
+    if (entry >= ADPCM_PREDICTOR_ENTRIES)
+        return NULL;
+
+    if ((predictor->valid & (1 << entry)) == 0) {
+        adpcm_compute_matrix(predictor->matrices[entry], table + 16*entry);
+        predictor->valid |= 1 << entry;
+    }
+
+    return predictor->matrices[entry];
+}
@@ -31,6 +31,13 @@ extern const int16_t RESAMPLE_LUT[64 * 4];
 
 int32_t rdot(size_t n, const int16_t *x, const int16_t *y);
 
+/* fast tier replacement of the 4-taps RESAMPLE_LUT filter: linear
+ * interpolation between its two middle taps x1 and x2 */
+static inline int16_t resample_linear_sample(int16_t x1, int16_t x2, uint16_t frac)
+{
+    return (int16_t)(x1 + (((int32_t)(x2 - x1) * (frac >> 1)) >> 15));
+}
+
 static inline int16_t adpcm_predict_sample(uint8_t byte, uint8_t mask,
         unsigned lshift, unsigned rshift)
 {
@@ -42,4 +49,30 @@ static inline int16_t adpcm_predict_sample(uint8_t byte, uint8_t mask,
 void adpcm_compute_residuals(int16_t* dst, const int16_t* src,
         const int16_t* cb_entry, const int16_t* last_samples, size_t count);
 
+/* Residuals of a codebook entry are a linear map of (l1, l2, src[0..7]).
+ * Its 8x10 matrix is stored as 5 column pairs of 8 rows, with both
+ * coefficients of a pair adjacent:
+ *   matrix[16*p + 2*i + k] = M[i][2*p + k] */
+enum { ADPCM_MATRIX_SIZE = 80 };
+enum { ADPCM_PREDICTOR_ENTRIES = 8 };
+
+void adpcm_compute_matrix(int16_t* matrix, const int16_t* cb_entry);
+
+/* matrices of the codebook entries held by an ADPCM table,
+ * valid has one bit per entry whose matrix is up to date */
+struct adpcm_predictor_t {
+    int16_t matrices[ADPCM_PREDICTOR_ENTRIES][ADPCM_MATRIX_SIZE];
+    uint8_t valid;
+};
+
+void adpcm_predictor_load(struct adpcm_predictor_t* predictor, const int16_t* table);
+
+static inline void adpcm_predictor_invalidate(struct adpcm_predictor_t* predictor)
+{
+    predictor->valid = 0;
+}
+
+const int16_t* adpcm_predictor_matrix(struct adpcm_predictor_t* predictor,
+        const int16_t* table, unsigned entry);
+
 #endif
@@ -0,0 +1,563 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_kernels.c                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "arithmetics.h"
+#include "audio.h"
+#include "audio_kernels.h"
+#include "memory.h"
+
+/* scalar reference kernels */
+static void mix_scalar(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] + ((src[i] * gain) >> 15));
+}
+
+static void mix_round_scalar(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] + ((src[i] * gain + 0x4000) >> 15));
+}
+
+static void mix_high_scalar(int16_t* dst, const int16_t* src, size_t count, uint16_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] + (int16_t)((int32_t)(src[i] * gain) >> 16));
+}
+
+static void mix_gains_scalar(int16_t* dst, const int16_t* src, const int16_t* gains, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] + ((src[i] * gains[i]) >> 15));
+}
+
+static void add_scalar(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] + src[i]);
+}
+
+static void mult_q44_scalar(int16_t* dst, size_t count, int8_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = clamp_s16(dst[i] * gain >> 4);
+}
+
+static void overload_scalar(int16_t* dst, size_t count, int16_t gain, uint16_t attenuation)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        int16_t accu = clamp_s16(dst[i] * gain);
+        dst[i] = (accu * attenuation) >> 16;
+    }
+}
+
+static void dot4_scalar(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i, x += 4, h += 4)
+        dst[i] = clamp_s16((x[0] * h[0] + x[1] * h[1] + x[2] * h[2] + x[3] * h[3]) >> 15);
+}
+
+static void dot4_sat_scalar(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    size_t i, k;
+
+    for (i = 0; i < count; ++i, x += 4, h += 4) {
+        int32_t accu = 0;
+
+        for (k = 0; k < 4; ++k)
+            accu = clamp_s16(accu + ((x[k] * h[k]) >> 15));
+
+        dst[i] = accu;
+    }
+}
+
+static void fir4_scalar(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i, ++src)
+        dst[i] = clamp_s16((src[0] * h[0] + src[1] * h[1] + src[2] * h[2] + src[3] * h[3]) >> 15);
+}
+
+static void fir4_sat_scalar(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    size_t i, k;
+
+    for (i = 0; i < count; ++i, ++src) {
+        int32_t accu = 0;
+
+        for (k = 0; k < 4; ++k)
+            accu = clamp_s16(accu + ((src[k] * h[k]) >> 15));
+
+        dst[i] = accu;
+    }
+}
+
+static void envmix_nead_scalar(int16_t* const* buffers, const int16_t* in, size_t count,
+                               uint16_t* env_values, const uint16_t* env_steps, const int16_t* xors)
+{
+    size_t i, k;
+
+    for (i = 0; i < count; i += 8) {
+        for (k = i; k < i + 8; ++k) {
+            int16_t l  = (((int32_t)in[k] * (uint32_t)env_values[0]) >> 16) ^ xors[0];
+            int16_t r  = (((int32_t)in[k] * (uint32_t)env_values[1]) >> 16) ^ xors[1];
+            int16_t l2 = (((int32_t)l * (uint32_t)env_values[2]) >> 16) ^ xors[2];
+            int16_t r2 = (((int32_t)r * (uint32_t)env_values[2]) >> 16) ^ xors[3];
+
+            buffers[0][k] = clamp_s16(buffers[0][k] + l);
+            buffers[1][k] = clamp_s16(buffers[1][k] + r);
+            buffers[2][k] = clamp_s16(buffers[2][k] + l2);
+            buffers[3][k] = clamp_s16(buffers[3][k] + r2);
+        }
+
+        env_values[0] += env_steps[0];
+        env_values[1] += env_steps[1];
+        env_values[2] += env_steps[2];
+    }
+}
+
+static void filter_scalar(int16_t* samples, int16_t* history, size_t blocks, const int16_t* lut)
+{
+    size_t i;
+
+    for (i = 0; i < blocks; ++i, samples += 8) {
+        int32_t v[8];
+        const int16_t* const in1 = history;
+        const int16_t* const in2 = samples;
+
+        v[1] =  in1[0] * lut[6];
+        v[1] += in1[3] * lut[7];
+        v[1] += in1[2] * lut[4];
+        v[1] += in1[5] * lut[5];
+        v[1] += in1[4] * lut[2];
+        v[1] += in1[7] * lut[3];
+        v[1] += in1[6] * lut[0];
+        v[1] += in2[1] * lut[1]; /* 1 */
+
+        v[0] =  in1[3] * lut[6];
+        v[0] += in1[2] * lut[7];
+        v[0] += in1[5] * lut[4];
+        v[0] += in1[4] * lut[5];
+        v[0] += in1[7] * lut[2];
+        v[0] += in1[6] * lut[3];
+        v[0] += in2[1] * lut[0];
+        v[0] += in2[0] * lut[1];
+
+        v[3] =  in1[2] * lut[6];
+        v[3] += in1[5] * lut[7];
+        v[3] += in1[4] * lut[4];
+        v[3] += in1[7] * lut[5];
+        v[3] += in1[6] * lut[2];
+        v[3] += in2[1] * lut[3];
+        v[3] += in2[0] * lut[0];
+        v[3] += in2[3] * lut[1];
+
+        v[2] =  in1[5] * lut[6];
+        v[2] += in1[4] * lut[7];
+        v[2] += in1[7] * lut[4];
+        v[2] += in1[6] * lut[5];
+        v[2] += in2[1] * lut[2];
+        v[2] += in2[0] * lut[3];
+        v[2] += in2[3] * lut[0];
+        v[2] += in2[2] * lut[1];
+
+        v[5] =  in1[4] * lut[6];
+        v[5] += in1[7] * lut[7];
+        v[5] += in1[6] * lut[4];
+        v[5] += in2[1] * lut[5];
+        v[5] += in2[0] * lut[2];
+        v[5] += in2[3] * lut[3];
+        v[5] += in2[2] * lut[0];
+        v[5] += in2[5] * lut[1];
+
+        v[4] =  in1[7] * lut[6];
+        v[4] += in1[6] * lut[7];
+        v[4] += in2[1] * lut[4];
+        v[4] += in2[0] * lut[5];
+        v[4] += in2[3] * lut[2];
+        v[4] += in2[2] * lut[3];
+        v[4] += in2[5] * lut[0];
+        v[4] += in2[4] * lut[1];
+
+        v[7] =  in1[6] * lut[6];
+        v[7] += in2[1] * lut[7];
+        v[7] += in2[0] * lut[4];
+        v[7] += in2[3] * lut[5];
+        v[7] += in2[2] * lut[2];
+        v[7] += in2[5] * lut[3];
+        v[7] += in2[4] * lut[0];
+        v[7] += in2[7] * lut[1];
+
+        v[6] =  in2[1] * lut[6];
+        v[6] += in2[0] * lut[7];
+        v[6] += in2[3] * lut[4];
+        v[6] += in2[2] * lut[5];
+        v[6] += in2[5] * lut[2];
+        v[6] += in2[4] * lut[3];
+        v[6] += in2[7] * lut[0];
+        v[6] += in2[6] * lut[1];
+
+        /* samples become the history of the next block */
+        memcpy(history, samples, 8 * sizeof(samples[0]));
+
+        samples[1] = ((v[1] + 0x4000) >> 15);
+        samples[0] = ((v[0] + 0x4000) >> 15);
+        samples[3] = ((v[3] + 0x4000) >> 15);
+        samples[2] = ((v[2] + 0x4000) >> 15);
+        samples[5] = ((v[5] + 0x4000) >> 15);
+        samples[4] = ((v[4] + 0x4000) >> 15);
+        samples[7] = ((v[7] + 0x4000) >> 15);
+        samples[6] = ((v[6] + 0x4000) >> 15);
+    }
+}
+
+static void adpcm_residuals_scalar(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                                   const int16_t* last_samples, size_t count)
+{
+    int16_t v[10];
+    size_t i, k;
+
+    v[0] = last_samples[0];
+    v[1] = last_samples[1];
+    for (k = 0; k < 8; ++k)
+        v[2 + k] = src[k];
+
+    /* row i has no coefficient past src[i] */
+    for (i = 0; i < count; ++i) {
+        int32_t accu = 0;
+
+        for (k = 0; k < 3 + i; ++k)
+            accu += matrix[16 * (k >> 1) + 2 * i + (k & 1)] * v[k];
+
+        dst[i] = clamp_s16(accu >> 11);
+    }
+}
+
+static void polef_scalar(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                         const int16_t* last_samples, uint16_t gain)
+{
+    int16_t v[10];
+    size_t i, k;
+
+    v[0] = last_samples[0];
+    v[1] = last_samples[1];
+    for (k = 0; k < 8; ++k)
+        v[2 + k] = src[k];
+
+    for (i = 0; i < 8; ++i) {
+        /* gains from 0x8000 were stored as gain - 0x10000 */
+        int32_t accu = (gain & 0x8000) ? (int32_t)((uint32_t)src[i] << 16) : 0;
+
+        for (k = 0; k < 3 + i; ++k)
+            accu += matrix[16 * (k >> 1) + 2 * i + (k & 1)] * v[k];
+
+        dst[i] = clamp_s16(accu >> 14);
+    }
+}
+
+static void iirf_fir_scalar(int32_t* dst, const int16_t* src, size_t count, int16_t h0, int16_t h1)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i] = vmulf(h0, src[i + 2]) + vmulf(h1, src[i + 1]) + vmulf(h0, src[i]);
+}
+
+static void adpcm_expand_4bits_scalar(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    size_t i;
+
+    for (i = 0; i < 8; ++i) {
+        *(dst++) = adpcm_predict_sample(src[i], 0xf0,  8, rshift);
+        *(dst++) = adpcm_predict_sample(src[i], 0x0f, 12, rshift);
+    }
+}
+
+static void adpcm_expand_2bits_scalar(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    size_t i;
+
+    for (i = 0; i < 4; ++i) {
+        *(dst++) = adpcm_predict_sample(src[i], 0xc0,  8, rshift);
+        *(dst++) = adpcm_predict_sample(src[i], 0x30, 10, rshift);
+        *(dst++) = adpcm_predict_sample(src[i], 0x0c, 12, rshift);
+        *(dst++) = adpcm_predict_sample(src[i], 0x03, 14, rshift);
+    }
+}
+
+static void copy_every_other_scalar(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        dst[i^S] = src[(2*i)^S];
+}
+
+static void interleave_scalar(int16_t* dst, const int16_t* left, const int16_t* right, size_t count)
+{
+    for (; count >= 2; count -= 2) {
+        int16_t l1 = *(left++);
+        int16_t l2 = *(left++);
+        int16_t r1 = *(right++);
+        int16_t r2 = *(right++);
+
+#ifdef M64P_BIG_ENDIAN
+        *(dst++) = l1;
+        *(dst++) = r1;
+        *(dst++) = l2;
+        *(dst++) = r2;
+#else
+        *(dst++) = r2;
+        *(dst++) = l2;
+        *(dst++) = r1;
+        *(dst++) = l1;
+#endif
+    }
+}
+
+/* (x * c) >> 16 with a wrapping 32-bit product */
+static inline int32_t mp3_mul(int32_t x, uint16_t c)
+{
+    return (int32_t)((uint32_t)x * c) >> 16;
+}
+
+static void mp3_butterflies_scalar(int32_t* v)
+{
+    static const uint16_t LUT2[8] = {
+        0xFEC4, 0xF4FA, 0xC5E4, 0xE1C4,
+        0x1916, 0x4A50, 0xA268, 0x78AE
+    };
+    static const uint16_t LUT3[4] = { 0xFB14, 0xD4DC, 0x31F2, 0x8E3A };
+    size_t i;
+
+    /* 8-wide butterflies */
+    for (i = 0; i < 8; ++i) {
+        v[16 + i] = v[0 + i] + v[8 + i];
+        v[24 + i] = mp3_mul(v[0 + i] - v[8 + i], LUT2[i]);
+    }
+
+    /* 4-wide butterflies */
+    for (i = 0; i < 4; ++i) {
+        v[0 + i]  = v[16 + i] + v[20 + i];
+        v[4 + i]  = mp3_mul(v[16 + i] - v[20 + i], LUT3[i]);
+
+        v[8 + i]  = v[24 + i] + v[28 + i];
+        v[12 + i] = mp3_mul(v[24 + i] - v[28 + i], LUT3[i]);
+    }
+
+    /* 2-wide butterflies */
+    for (i = 0; i < 16; i += 4) {
+        v[16 + i] = v[0 + i] + v[2 + i];
+        v[18 + i] = mp3_mul(v[0 + i] - v[2 + i], 0xEC84);
+
+        v[17 + i] = v[1 + i] + v[3 + i];
+        v[19 + i] = mp3_mul(v[1 + i] - v[3 + i], 0x61F8);
+    }
+}
+
+static void mp3_scale_scalar(int32_t* v, const uint16_t* scales, const int32_t* doubled, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        int32_t x = mp3_mul(v[i], scales[i]);
+        v[i] = x + (x & doubled[i]);
+    }
+}
+
+static void mp3_window_scalar(int32_t* dst, const int16_t* x, ptrdiff_t x_stride,
+                              const int16_t* h, ptrdiff_t h_stride, size_t count, int alternate)
+{
+    size_t i, k;
+
+    for (i = 0; i < count; ++i, x += x_stride, h += h_stride) {
+        int32_t accu = 0;
+
+        for (k = 0; k < 16; ++k) {
+            int32_t p = ((int32_t)x[k] * h[k] + 0x4000) >> 15;
+            accu += (alternate && (k & 1)) ? -p : p;
+        }
+
+        dst[i] = accu;
+    }
+}
+
+static void musyx_envmix_scalar(int16_t* const* dst, const int16_t* v, size_t count,
+                                int32_t* env, const int32_t* env_step)
+{
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k) {
+        for (i = 0; i < count; ++i) {
+            int32_t accu = (v[i] * (env[k] >> 16)) >> 15;
+
+            dst[k][i] = clamp_s16(dst[k][i] + accu);
+            env[k] += env_step[k];
+        }
+    }
+}
+
+static void musyx_envmix_wide_scalar(int32_t* const* dst, const int16_t* v, size_t count,
+                                     int32_t* env, const int32_t* env_step)
+{
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k) {
+        for (i = 0; i < count; ++i) {
+            dst[k][i] += (v[i] * (env[k] >> 16)) >> 15;
+            env[k] += env_step[k];
+        }
+    }
+}
+
+static void musyx_sfx_taps_scalar(int16_t* dst, const int16_t* const* taps, const int16_t* gains,
+                                  size_t tap_count, size_t count)
+{
+    size_t i, k;
+
+    for (k = 0; k < tap_count; ++k) {
+        for (i = 0; i < count; ++i)
+            dst[i] = clamp_s16(dst[i] + ((taps[k][i^S] * gains[k] + 0x4000) >> 15));
+    }
+}
+
+static void musyx_fir4_scalar(int16_t* dst, const int16_t* src, size_t count, const int32_t* h)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        int32_t v = (h[0] * src[i] + h[1] * src[i + 1] + h[2] * src[i + 2] + h[3] * src[i + 3]) >> 15;
+        dst[i] = clamp_s16(dst[i] + v);
+    }
+}
+
+const struct audio_kernels_t audio_kernels_scalar =
+{
+    mix_scalar,
+    mix_round_scalar,
+    mix_high_scalar,
+    mix_gains_scalar,
+    add_scalar,
+    mult_q44_scalar,
+    overload_scalar,
+    dot4_scalar,
+    dot4_sat_scalar,
+    fir4_scalar,
+    fir4_sat_scalar,
+    envmix_nead_scalar,
+    filter_scalar,
+    adpcm_residuals_scalar,
+    polef_scalar,
+    iirf_fir_scalar,
+    adpcm_expand_4bits_scalar,
+    adpcm_expand_2bits_scalar,
+    copy_every_other_scalar,
+    interleave_scalar,
+    mp3_butterflies_scalar,
+    mp3_scale_scalar,
+    mp3_window_scalar,
+    musyx_envmix_scalar,
+    musyx_envmix_wide_scalar,
+    musyx_sfx_taps_scalar,
+    musyx_fir4_scalar
+};
+
+
+#ifdef AUDIO_KERNELS_X86
+#ifdef _MSC_VER
+static int cpu_has_sse2(void)
+{
+    int regs[4];
+
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+}
+
+static int cpu_has_avx2(void)
+{
+    int regs[4];
+
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return 0;
+
+    /* cpu supports AVX and OS saves YMM state */
+    __cpuid(regs, 1);
+    if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0)
+        return 0;
+    if ((_xgetbv(0) & 6) != 6)
+        return 0;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+}
+#else
+static int cpu_has_sse2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static int cpu_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+#endif
+
+const struct audio_kernels_t* audio_kernels_select(void)
+{
+#ifdef AUDIO_KERNELS_X86
+    if (cpu_has_avx2())
+        return &audio_kernels_avx2;
+
+    if (cpu_has_sse2())
+        return &audio_kernels_sse2;
+#endif
+
+    return &audio_kernels_scalar;
+}
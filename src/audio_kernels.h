@@ -0,0 +1,190 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_kernels.h                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef AUDIO_KERNELS_H
+#define AUDIO_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "hle_internal.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUDIO_KERNELS_X86
+#endif
+
+/* Element-wise audio kernels shared by the audio ucodes.
+ * Every implementation must be bit-exact with the scalar one. Kernels taking
+ * a src and a dst must give the same result as a forward sample-by-sample
+ * loop, even when both ranges overlap. */
+struct audio_kernels_t
+{
+    /* dst = clamp(dst + ((src * gain) >> 15)) */
+    void (*mix)(int16_t* dst, const int16_t* src, size_t count, int16_t gain);
+
+    /* dst = clamp(dst + ((src * gain + 0x4000) >> 15)) */
+    void (*mix_round)(int16_t* dst, const int16_t* src, size_t count, int16_t gain);
+
+    /* dst = clamp(dst + ((src * gain) >> 16)), gain being unsigned */
+    void (*mix_high)(int16_t* dst, const int16_t* src, size_t count, uint16_t gain);
+
+    /* dst = clamp(dst + ((src * gains) >> 15)), with one gain per sample.
+     * src and gains must not overlap dst */
+    void (*mix_gains)(int16_t* dst, const int16_t* src, const int16_t* gains, size_t count);
+
+    /* dst = clamp(dst + src) */
+    void (*add)(int16_t* dst, const int16_t* src, size_t count);
+
+    /* dst = clamp((dst * gain) >> 4) */
+    void (*mult_q44)(int16_t* dst, size_t count, int8_t gain);
+
+    /* dst = (clamp(dst * gain) * attenuation) >> 16 */
+    void (*overload)(int16_t* dst, size_t count, int16_t gain, uint16_t attenuation);
+
+    /* 4-tap filters: x and h hold 4 consecutive taps per output sample
+     * and h must not hold -32768 (true of RESAMPLE_LUT).
+     * dot4:     dst = clamp((x0*h0 + x1*h1 + x2*h2 + x3*h3) >> 15)
+     * dot4_sat: same, but each (xi*hi) >> 15 term is accumulated with
+     *           saturation, in tap order */
+    void (*dot4)(int16_t* dst, const int16_t* x, const int16_t* h, size_t count);
+    void (*dot4_sat)(int16_t* dst, const int16_t* x, const int16_t* h, size_t count);
+
+    /* same filters with a single set of taps sliding over src,
+     * i.e. x = src[i], src[i+1], src[i+2], src[i+3] for output i */
+    void (*fir4)(int16_t* dst, const int16_t* src, size_t count, const int16_t* h);
+    void (*fir4_sat)(int16_t* dst, const int16_t* src, size_t count, const int16_t* h);
+
+    /* nead envmixer over count samples, a multiple of 8, with
+     * buffers = dl, dr, wl, wr:
+     *   l  = ((in * env0) >> 16) ^ xor0,   r  = ((in * env1) >> 16) ^ xor1
+     *   l2 = ((l * env2) >> 16) ^ xor2,    r2 = ((r * env2) >> 16) ^ xor3
+     * each product being signed by unsigned, then accumulated with
+     * saturation into their buffer. Envelopes step after every group of 8
+     * samples. Buffers and in must either coincide or lie 8 samples apart */
+    void (*envmix_nead)(int16_t* const* buffers, const int16_t* in, size_t count,
+                        uint16_t* env_values, const uint16_t* env_steps, const int16_t* xors);
+
+    /* 8-tap filter of the nead FILTER command, in place over blocks of 8
+     * samples: each output is the truncated ((... + 0x4000) >> 15) dot
+     * product of lut with the 8 samples ending at its input, history
+     * holding the block preceding samples on entry and the last input
+     * block on return. Samples are pair-swapped as in DMEM */
+    void (*filter)(int16_t* samples, int16_t* history, size_t blocks, const int16_t* lut);
+
+    /* ADPCM residuals of a codebook entry from its matrix (see
+     * adpcm_compute_matrix): dst = clamp((M . (l1, l2, src[0..7])) >> 11)
+     * for the first count (<= 8) rows. src must hold 8 samples and must
+     * not overlap dst */
+    void (*adpcm_residuals)(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                            const int16_t* last_samples, size_t count);
+
+    /* one block of the POLEF filter, from a matrix laid out like the ADPCM
+     * ones whose diagonal holds gain as a signed value:
+     * dst = clamp((M . (l1, l2, src[0..7]) + gain fix-up) >> 14) */
+    void (*polef)(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                  const int16_t* last_samples, uint16_t gain);
+
+    /* FIR part of the IIRF filter:
+     * dst = vmulf(h0, src[i+2]) + vmulf(h1, src[i+1]) + vmulf(h0, src[i]) */
+    void (*iirf_fir)(int32_t* dst, const int16_t* src, size_t count, int16_t h0, int16_t h1);
+
+    /* expand the 16 ADPCM samples of a frame payload, i.e. 8 bytes of
+     * 4-bit samples or 4 bytes of 2-bit samples (most significant first),
+     * into dst = (sample << 12 or 14) >> rshift */
+    void (*adpcm_expand_4bits)(int16_t* dst, const uint8_t* src, unsigned rshift);
+    void (*adpcm_expand_2bits)(int16_t* dst, const uint8_t* src, unsigned rshift);
+
+    /* DMEM layout helpers, samples being pair-swapped as in DMEM:
+     * copy_every_other: dst = src[0], src[2], src[4], ...
+     * interleave:       dst = left[0], right[0], left[1], right[1], ...
+     * for count output samples, respectively count samples per channel
+     * (a multiple of 2). dst must not overlap the sources */
+    void (*copy_every_other)(int16_t* dst, const int16_t* src, size_t count);
+    void (*interleave)(int16_t* dst, const int16_t* left, const int16_t* right, size_t count);
+
+    /* MP3 polyphase synthesis. Scaled values are ((v * c) >> 16) computed
+     * with wrapping 32-bit products, as the mp3 ucode does.
+     * mp3_butterflies: 8, 4 then 2-wide butterflies of v[0..15], leaving
+     *                  the 4-wide stage in v[0..15] and the last one in
+     *                  v[16..31]. Differences are scaled by fixed factors
+     * mp3_scale:       v = (v * scales) >> 16, then doubled where doubled
+     *                  is -1 (it must hold 0 or -1)
+     * mp3_window:      dst[i] = sum of ((x[k] * h[k] + 0x4000) >> 15) over
+     *                  16 taps, every odd tap being subtracted instead when
+     *                  alternate is set, x and h then moving by their stride
+     *                  for the next output */
+    void (*mp3_butterflies)(int32_t* v);
+    void (*mp3_scale)(int32_t* v, const uint16_t* scales, const int32_t* doubled, size_t count);
+    void (*mp3_window)(int32_t* dst, const int16_t* x, ptrdiff_t x_stride,
+                       const int16_t* h, ptrdiff_t h_stride, size_t count, int alternate);
+
+    /* MusyX voice envelope mixer, over count samples of v and 4 buses:
+     *   accu = (v[i] * (env[k] >> 16)) >> 15, env[k] then stepping by env_step[k]
+     * musyx_envmix:      dst[k][i] = clamp(dst[k][i] + accu)
+     * musyx_envmix_wide: dst[k][i] += accu
+     * env holds the envelopes following the last sample on return */
+    void (*musyx_envmix)(int16_t* const* dst, const int16_t* v, size_t count,
+                         int32_t* env, const int32_t* env_step);
+    void (*musyx_envmix_wide)(int32_t* const* dst, const int16_t* v, size_t count,
+                              int32_t* env, const int32_t* env_step);
+
+    /* MusyX SFX stage.
+     * musyx_sfx_taps: for each of the tap_count (<= 8) taps in turn,
+     *                 dst = clamp(dst + ((tap * gain + 0x4000) >> 15)), taps
+     *                 being pair-swapped as in DRAM and not overlapping dst
+     * musyx_fir4:     dst = clamp(dst + ((x0*h0 + x1*h1 + x2*h2 + x3*h3) >> 15))
+     *                 with x = src[i], src[i+1], src[i+2], src[i+3], the sum
+     *                 wrapping on 32 bits. src must not overlap dst */
+    void (*musyx_sfx_taps)(int16_t* dst, const int16_t* const* taps, const int16_t* gains,
+                           size_t tap_count, size_t count);
+    void (*musyx_fir4)(int16_t* dst, const int16_t* src, size_t count, const int32_t* h);
+};
+
+extern const struct audio_kernels_t audio_kernels_scalar;
+#ifdef AUDIO_KERNELS_X86
+extern const struct audio_kernels_t audio_kernels_sse2;
+extern const struct audio_kernels_t audio_kernels_avx2;
+#endif
+
+/* pick the best implementation supported by the host cpu */
+const struct audio_kernels_t* audio_kernels_select(void);
+
+/* kernels to use for the current task */
+static inline const struct audio_kernels_t* audio_kernels(const struct hle_t* hle)
+{
+    return (hle->reference || hle->kernels == NULL)
+        ? &audio_kernels_scalar
+        : hle->kernels;
+}
+
+/* true if dst trails src by less than one vector of lanes samples:
+ * a vectorized pass would then read src samples before the scalar loop
+ * would have updated them through dst */
+static inline int audio_kernels_overlap(const int16_t* dst, const int16_t* src, size_t lanes)
+{
+    uintptr_t d = (uintptr_t)dst;
+    uintptr_t s = (uintptr_t)src;
+
+    return d > s && d - s < lanes * sizeof(int16_t);
+}
+
+#endif
@@ -0,0 +1,898 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_kernels_avx2.c                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <string.h>
+
+#include "audio_kernels.h"
+
+#ifdef AUDIO_KERNELS_X86
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+enum { LANES = 16 };
+
+/* sign extend the 16 samples of x into two vectors of 32-bit values
+ * (in-lane order, matching the one used by _mm256_packs_epi32) */
+static inline TARGET_AVX2 __m256i widen_lo(__m256i x)
+{
+    return _mm256_srai_epi32(_mm256_unpacklo_epi16(x, x), 16);
+}
+
+static inline TARGET_AVX2 __m256i widen_hi(__m256i x)
+{
+    return _mm256_srai_epi32(_mm256_unpackhi_epi16(x, x), 16);
+}
+
+/* compute the 32-bit products of x and y and add round to each of them */
+static inline TARGET_AVX2 void mul_32(__m256i x, __m256i y, __m256i round,
+                                      __m256i* p0, __m256i* p1)
+{
+    __m256i lo = _mm256_mullo_epi16(x, y);
+    __m256i hi = _mm256_mulhi_epi16(x, y);
+
+    *p0 = _mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), round);
+    *p1 = _mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), round);
+}
+
+/* (x * gain) >> 16 for an unsigned gain: pmulhw sees gain - 0x10000 when
+ * the top bit is set, which must be compensated by adding x back */
+static inline TARGET_AVX2 __m256i mul_high_u16(__m256i x, __m256i gain, __m256i fix_mask)
+{
+    return _mm256_add_epi16(_mm256_mulhi_epi16(x, gain), _mm256_and_si256(x, fix_mask));
+}
+
+/* vpmulhrsw does not match the scalar code for -32768 * -32768, so products
+ * are computed on 32 bits and saturated back with vpackssdw.
+ * unpack and pack both work within 128-bit lanes, so sample order is kept */
+static TARGET_AVX2 void mix_rounded(int16_t* dst, const int16_t* src, size_t count,
+                                    int16_t gain, int32_t round)
+{
+    const __m256i vgain  = _mm256_set1_epi16(gain);
+    const __m256i vround = _mm256_set1_epi32(round);
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i p0, p1;
+
+        mul_32(s, vgain, vround, &p0, &p1);
+        p0 = _mm256_add_epi32(_mm256_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm256_add_epi32(_mm256_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(p0, p1));
+    }
+
+    if (round == 0)
+        audio_kernels_scalar.mix(dst + i, src + i, count - i, gain);
+    else
+        audio_kernels_scalar.mix_round(dst + i, src + i, count - i, gain);
+}
+
+static TARGET_AVX2 void mix_avx2(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    if (audio_kernels_overlap(dst, src, LANES))
+        audio_kernels_scalar.mix(dst, src, count, gain);
+    else
+        mix_rounded(dst, src, count, gain, 0);
+}
+
+static TARGET_AVX2 void mix_round_avx2(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    if (audio_kernels_overlap(dst, src, LANES))
+        audio_kernels_scalar.mix_round(dst, src, count, gain);
+    else
+        mix_rounded(dst, src, count, gain, 0x4000);
+}
+
+static TARGET_AVX2 void mix_high_avx2(int16_t* dst, const int16_t* src, size_t count, uint16_t gain)
+{
+    const __m256i vgain = _mm256_set1_epi16((int16_t)gain);
+    const __m256i fix   = _mm256_set1_epi16((gain & 0x8000) ? -1 : 0);
+    size_t i = 0;
+
+    if (!audio_kernels_overlap(dst, src, LANES)) {
+        for (; i + LANES <= count; i += LANES) {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+            d = _mm256_adds_epi16(d, mul_high_u16(s, vgain, fix));
+            _mm256_storeu_si256((__m256i*)(dst + i), d);
+        }
+    }
+
+    audio_kernels_scalar.mix_high(dst + i, src + i, count - i, gain);
+}
+
+static TARGET_AVX2 void mix_gains_avx2(int16_t* dst, const int16_t* src, const int16_t* gains, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i g = _mm256_loadu_si256((const __m256i*)(gains + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i p0, p1;
+
+        mul_32(s, g, _mm256_setzero_si256(), &p0, &p1);
+        p0 = _mm256_add_epi32(_mm256_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm256_add_epi32(_mm256_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.mix_gains(dst + i, src + i, gains + i, count - i);
+}
+
+static TARGET_AVX2 void add_avx2(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i = 0;
+
+    if (!audio_kernels_overlap(dst, src, LANES)) {
+        for (; i + LANES <= count; i += LANES) {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_adds_epi16(d, s));
+        }
+    }
+
+    audio_kernels_scalar.add(dst + i, src + i, count - i);
+}
+
+static TARGET_AVX2 void mult_q44_avx2(int16_t* dst, size_t count, int8_t gain)
+{
+    const __m256i vgain = _mm256_set1_epi16(gain);
+    const __m256i zero  = _mm256_setzero_si256();
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i p0, p1;
+
+        mul_32(d, vgain, zero, &p0, &p1);
+        p0 = _mm256_srai_epi32(p0, 4);
+        p1 = _mm256_srai_epi32(p1, 4);
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.mult_q44(dst + i, count - i, gain);
+}
+
+static TARGET_AVX2 void overload_avx2(int16_t* dst, size_t count, int16_t gain, uint16_t attenuation)
+{
+    const __m256i vgain  = _mm256_set1_epi16(gain);
+    const __m256i vatten = _mm256_set1_epi16((int16_t)attenuation);
+    const __m256i fix    = _mm256_set1_epi16((attenuation & 0x8000) ? -1 : 0);
+    const __m256i zero   = _mm256_setzero_si256();
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i p0, p1;
+
+        mul_32(d, vgain, zero, &p0, &p1);
+        d = mul_high_u16(_mm256_packs_epi32(p0, p1), vatten, fix);
+
+        _mm256_storeu_si256((__m256i*)(dst + i), d);
+    }
+
+    audio_kernels_scalar.overload(dst + i, count - i, gain, attenuation);
+}
+
+/* pick 32-bit elements out of a and b within each 128-bit lane, as vshufps does */
+#define SHUFFLE_PAIR(a, b, imm) \
+    _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), imm))
+
+/* sums the 32-bit products of 4 outputs held by two vpmaddwd results.
+ * Outputs end up in (0, 1, 4, 5 | 2, 3, 6, 7) order */
+static inline TARGET_AVX2 __m256i hadd_pairs(__m256i m0, __m256i m1)
+{
+    return _mm256_add_epi32(SHUFFLE_PAIR(m0, m1, _MM_SHUFFLE(2, 0, 2, 0)),
+                            SHUFFLE_PAIR(m0, m1, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+/* accumulates with saturation the 4 taps of the 4 outputs held by p
+ * and returns them sign extended into the odd 32-bit elements */
+static inline TARGET_AVX2 __m256i sat_sum4(__m256i p)
+{
+    __m256i accu = _mm256_adds_epi16(p, _mm256_srli_epi64(p, 16));
+    accu = _mm256_adds_epi16(accu, _mm256_srli_epi64(p, 32));
+    accu = _mm256_adds_epi16(accu, _mm256_srli_epi64(p, 48));
+
+    return _mm256_srai_epi32(_mm256_slli_epi64(accu, 48), 16);
+}
+
+/* (x * h) >> 15, which fits in 16 bits as long as h is not -32768 */
+static inline TARGET_AVX2 __m256i mul_q15(__m256i x, __m256i h)
+{
+    return _mm256_or_si256(_mm256_slli_epi16(_mm256_mulhi_epi16(x, h), 1),
+                           _mm256_srli_epi16(_mm256_mullo_epi16(x, h), 15));
+}
+
+/* packs two vectors of outputs in (0, 1, 4, 5 | 2, 3, 6, 7) order */
+static inline TARGET_AVX2 __m256i pack_outputs(__m256i lo, __m256i hi)
+{
+    return _mm256_permutevar8x32_epi32(_mm256_packs_epi32(lo, hi),
+                                       _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+static TARGET_AVX2 void dot4_avx2(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    __m256i m[4];
+    size_t i, k;
+
+    for (i = 0; i + LANES <= count; i += LANES, x += 4 * LANES, h += 4 * LANES) {
+        for (k = 0; k < 4; ++k)
+            m[k] = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)(x + 16 * k)),
+                                     _mm256_loadu_si256((const __m256i*)(h + 16 * k)));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), pack_outputs(
+                    _mm256_srai_epi32(hadd_pairs(m[0], m[1]), 15),
+                    _mm256_srai_epi32(hadd_pairs(m[2], m[3]), 15)));
+    }
+
+    audio_kernels_scalar.dot4(dst + i, x, h, count - i);
+}
+
+static TARGET_AVX2 void dot4_sat_avx2(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    __m256i m[4];
+    size_t i, k;
+
+    for (i = 0; i + LANES <= count; i += LANES, x += 4 * LANES, h += 4 * LANES) {
+        for (k = 0; k < 4; ++k)
+            m[k] = sat_sum4(mul_q15(_mm256_loadu_si256((const __m256i*)(x + 16 * k)),
+                                    _mm256_loadu_si256((const __m256i*)(h + 16 * k))));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), pack_outputs(
+                    SHUFFLE_PAIR(m[0], m[1], _MM_SHUFFLE(3, 1, 3, 1)),
+                    SHUFFLE_PAIR(m[2], m[3], _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    audio_kernels_scalar.dot4_sat(dst + i, x, h, count - i);
+}
+
+static TARGET_AVX2 void fir4_avx2(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    __m256i vh[4];
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k)
+        vh[k] = _mm256_set1_epi16(h[k]);
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i p0, p1, q0, q1;
+
+        mul_32(_mm256_loadu_si256((const __m256i*)(src + i)), vh[0], _mm256_setzero_si256(), &p0, &p1);
+        for (k = 1; k < 4; ++k) {
+            mul_32(_mm256_loadu_si256((const __m256i*)(src + i + k)), vh[k], _mm256_setzero_si256(), &q0, &q1);
+            p0 = _mm256_add_epi32(p0, q0);
+            p1 = _mm256_add_epi32(p1, q1);
+        }
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(
+                    _mm256_srai_epi32(p0, 15), _mm256_srai_epi32(p1, 15)));
+    }
+
+    audio_kernels_scalar.fir4(dst + i, src + i, count - i, h);
+}
+
+static TARGET_AVX2 void fir4_sat_avx2(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    __m256i vh[4];
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k)
+        vh[k] = _mm256_set1_epi16(h[k]);
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i accu = mul_q15(_mm256_loadu_si256((const __m256i*)(src + i)), vh[0]);
+
+        for (k = 1; k < 4; ++k)
+            accu = _mm256_adds_epi16(accu, mul_q15(_mm256_loadu_si256((const __m256i*)(src + i + k)), vh[k]));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), accu);
+    }
+
+    audio_kernels_scalar.fir4_sat(dst + i, src + i, count - i, h);
+}
+
+/* the unsigned gains of the samples are held by the 16-bit lanes of env,
+ * whose sign bits give the mul_high_u16 fix mask */
+static inline TARGET_AVX2 __m256i mul_env(__m256i x, __m256i env)
+{
+    return mul_high_u16(x, env, _mm256_srai_epi16(env, 15));
+}
+
+/* accumulates x into 16 samples of dst. Buffers are loaded and stored one at a
+ * time so that coinciding buffers accumulate in turn, as in the scalar code */
+static inline TARGET_AVX2 void accumulate(int16_t* dst, __m256i x)
+{
+    _mm256_storeu_si256((__m256i*)dst, _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)dst), x));
+}
+
+/* envelopes of two consecutive groups of 8 samples, one per 128-bit lane */
+static inline TARGET_AVX2 __m256i envelope_pair(uint16_t value, uint16_t step)
+{
+    return _mm256_setr_m128i(_mm_set1_epi16((int16_t)value),
+                             _mm_set1_epi16((int16_t)(uint16_t)(value + step)));
+}
+
+/* vectors span 2 groups of 8 samples, buffers must then either coincide or
+ * lie 16 samples apart for loads to be unaffected by previous stores */
+static int groups_apart(int16_t* const* buffers, const int16_t* in)
+{
+    const int16_t* ranges[5];
+    size_t i, j;
+
+    ranges[0] = in;
+    for (i = 0; i < 4; ++i)
+        ranges[i + 1] = buffers[i];
+
+    for (i = 0; i < 5; ++i) {
+        for (j = 0; j < i; ++j) {
+            if (ranges[i] != ranges[j]
+             && (audio_kernels_overlap(ranges[i], ranges[j], LANES)
+              || audio_kernels_overlap(ranges[j], ranges[i], LANES)))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+static TARGET_AVX2 void envmix_nead_avx2(int16_t* const* buffers, const int16_t* in, size_t count,
+                                         uint16_t* env_values, const uint16_t* env_steps, const int16_t* xors)
+{
+    const __m256i xor_l  = _mm256_set1_epi16(xors[0]);
+    const __m256i xor_r  = _mm256_set1_epi16(xors[1]);
+    const __m256i xor_l2 = _mm256_set1_epi16(xors[2]);
+    const __m256i xor_r2 = _mm256_set1_epi16(xors[3]);
+    size_t i = 0;
+    unsigned k;
+
+    if (groups_apart(buffers, in)) {
+        for (; i + LANES <= count; i += LANES) {
+            __m256i x    = _mm256_loadu_si256((const __m256i*)(in + i));
+            __m256i env2 = envelope_pair(env_values[2], env_steps[2]);
+            __m256i l    = _mm256_xor_si256(mul_env(x, envelope_pair(env_values[0], env_steps[0])), xor_l);
+            __m256i r    = _mm256_xor_si256(mul_env(x, envelope_pair(env_values[1], env_steps[1])), xor_r);
+
+            accumulate(buffers[0] + i, l);
+            accumulate(buffers[1] + i, r);
+            accumulate(buffers[2] + i, _mm256_xor_si256(mul_env(l, env2), xor_l2));
+            accumulate(buffers[3] + i, _mm256_xor_si256(mul_env(r, env2), xor_r2));
+
+            env_values[0] += 2 * env_steps[0];
+            env_values[1] += 2 * env_steps[1];
+            env_values[2] += 2 * env_steps[2];
+        }
+    }
+
+    if (i < count) {
+        int16_t* tails[4];
+
+        for (k = 0; k < 4; ++k)
+            tails[k] = buffers[k] + i;
+
+        audio_kernels_scalar.envmix_nead(tails, in + i, count - i, env_values, env_steps, xors);
+    }
+}
+
+/* same matrix as the SSE2 kernel: the 8 outputs of a column pair fill a vector */
+static TARGET_AVX2 void filter_matrix(int16_t* matrix, const int16_t* lut)
+{
+    unsigned r, k;
+
+    memset(matrix, 0, 128 * sizeof(matrix[0]));
+
+    for (r = 0; r < 8; ++r) {
+        for (k = 0; k < 8; ++k) {
+            unsigned column = ((r ^ 1) + 1 + k) ^ 1;
+
+            matrix[16 * (column >> 1) + 2 * r + (column & 1)] = lut[(7 - k) ^ 1];
+        }
+    }
+}
+
+static TARGET_AVX2 void filter_avx2(int16_t* samples, int16_t* history, size_t blocks, const int16_t* lut)
+{
+    int16_t matrix[128];
+    __m256i columns[8];
+    __m128i previous = _mm_loadu_si128((const __m128i*)history);
+    size_t i;
+    unsigned p;
+
+    filter_matrix(matrix, lut);
+    for (p = 0; p < 8; ++p)
+        columns[p] = _mm256_loadu_si256((const __m256i*)(matrix + 16 * p));
+
+    for (i = 0; i < blocks; ++i, samples += 8) {
+        __m128i current = _mm_loadu_si128((const __m128i*)samples);
+        __m256i window[2];
+        __m256i accu = _mm256_setzero_si256();
+
+        window[0] = _mm256_castsi128_si256(previous);
+        window[1] = _mm256_castsi128_si256(current);
+
+        for (p = 0; p < 8; ++p)
+            accu = _mm256_add_epi32(accu, _mm256_madd_epi16(columns[p],
+                        _mm256_permutevar8x32_epi32(window[p >> 2], _mm256_set1_epi32(p & 3))));
+
+        /* keep the low 16 bits of each (accu + 0x4000) >> 15 */
+        accu = _mm256_srai_epi32(_mm256_add_epi32(accu, _mm256_set1_epi32(0x4000)), 15);
+        accu = _mm256_srai_epi32(_mm256_slli_epi32(accu, 16), 16);
+
+        _mm_storeu_si128((__m128i*)samples, _mm_packs_epi32(
+                    _mm256_castsi256_si128(accu), _mm256_extracti128_si256(accu, 1)));
+        previous = current;
+    }
+
+    _mm_storeu_si128((__m128i*)history, previous);
+}
+
+/* broadcast the (a, b) pair of samples to every 32-bit element */
+static inline TARGET_AVX2 __m256i set1_pair(int16_t a, int16_t b)
+{
+    return _mm256_set1_epi32((int32_t)(uint16_t)a | ((int32_t)(uint16_t)b << 16));
+}
+
+/* products of an 8x10 matrix stored by column pairs with (l1, l2, src[0..7]) */
+static inline TARGET_AVX2 __m256i matrix_products(const int16_t* src, const int16_t* matrix,
+                                                  const int16_t* last_samples)
+{
+    __m256i accu = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)matrix),
+                                     set1_pair(last_samples[0], last_samples[1]));
+    size_t p;
+
+    for (p = 1; p < 5; ++p)
+        accu = _mm256_add_epi32(accu, _mm256_madd_epi16(
+                    _mm256_loadu_si256((const __m256i*)(matrix + 16 * p)),
+                    set1_pair(src[2 * p - 2], src[2 * p - 1])));
+
+    return accu;
+}
+
+static TARGET_AVX2 void adpcm_residuals_avx2(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                                             const int16_t* last_samples, size_t count)
+{
+    int16_t outputs[8];
+    __m256i accu = _mm256_srai_epi32(matrix_products(src, matrix, last_samples), 11);
+
+    _mm_storeu_si128((__m128i*)outputs, _mm_packs_epi32(
+                _mm256_castsi256_si128(accu), _mm256_extracti128_si256(accu, 1)));
+    memcpy(dst, outputs, count * sizeof(dst[0]));
+}
+
+static TARGET_AVX2 void polef_avx2(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                                   const int16_t* last_samples, uint16_t gain)
+{
+    __m256i accu = matrix_products(src, matrix, last_samples);
+
+    /* gains from 0x8000 were stored as gain - 0x10000 */
+    if (gain & 0x8000)
+        accu = _mm256_add_epi32(accu, _mm256_slli_epi32(
+                    _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src)), 16));
+
+    accu = _mm256_srai_epi32(accu, 14);
+    _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(
+                _mm256_castsi256_si128(accu), _mm256_extracti128_si256(accu, 1)));
+}
+
+/* vmulf of 8 samples, sign extended to 32 bits */
+static inline TARGET_AVX2 __m256i vmulf_32(const int16_t* x, __m256i h)
+{
+    __m256i p = _mm256_mullo_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)x)), h);
+
+    return _mm256_srai_epi32(_mm256_add_epi32(p, _mm256_set1_epi32(0x4000)), 15);
+}
+
+static TARGET_AVX2 void iirf_fir_avx2(int32_t* dst, const int16_t* src, size_t count, int16_t h0, int16_t h1)
+{
+    const __m256i vh0 = _mm256_set1_epi32(h0);
+    const __m256i vh1 = _mm256_set1_epi32(h1);
+    size_t i;
+
+    /* each vmulf is rounded on its own */
+    for (i = 0; i + 8 <= count; i += 8)
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(
+                    _mm256_add_epi32(vmulf_32(src + i + 2, vh0), vmulf_32(src + i + 1, vh1)),
+                    vmulf_32(src + i, vh0)));
+
+    audio_kernels_scalar.iirf_fir(dst + i, src + i, count - i, h0, h1);
+}
+
+/* same expansion as the SSE2 kernels, vpshufb spreading the bytes of the
+ * payload to the upper half of the 16 lanes of their samples */
+static inline TARGET_AVX2 void adpcm_expand(int16_t* dst, __m128i bytes, __m256i spread,
+                                            __m256i scale, __m256i mask, unsigned rshift)
+{
+    __m256i x = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(bytes), spread);
+
+    x = _mm256_and_si256(_mm256_mullo_epi16(x, scale), mask);
+    _mm256_storeu_si256((__m256i*)dst, _mm256_sra_epi16(x, _mm_cvtsi32_si128(rshift)));
+}
+
+static TARGET_AVX2 void adpcm_expand_4bits_avx2(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    adpcm_expand(dst, _mm_loadl_epi64((const __m128i*)src),
+            _mm256_setr_epi8(-1, 0, -1, 0, -1, 1, -1, 1, -1, 2, -1, 2, -1, 3, -1, 3,
+                             -1, 4, -1, 4, -1, 5, -1, 5, -1, 6, -1, 6, -1, 7, -1, 7),
+            _mm256_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16),
+            _mm256_set1_epi16((int16_t)0xf000), rshift);
+}
+
+static TARGET_AVX2 void adpcm_expand_2bits_avx2(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    int32_t payload;
+
+    memcpy(&payload, src, sizeof(payload));
+
+    adpcm_expand(dst, _mm_cvtsi32_si128(payload),
+            _mm256_setr_epi8(-1, 0, -1, 0, -1, 0, -1, 0, -1, 1, -1, 1, -1, 1, -1, 1,
+                             -1, 2, -1, 2, -1, 2, -1, 2, -1, 3, -1, 3, -1, 3, -1, 3),
+            _mm256_setr_epi16(1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64, 1, 4, 16, 64),
+            _mm256_set1_epi16((int16_t)0xc000), rshift);
+}
+
+/* same as the SSE2 kernels, with packs and unpacks fixed across lanes */
+static TARGET_AVX2 void copy_every_other_avx2(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i a = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(src + 2*i)), 16);
+        __m256i b = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(src + 2*i + LANES)), 16);
+        __m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+
+        x = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xb1), 0xb1);
+        _mm256_storeu_si256((__m256i*)(dst + i), x);
+    }
+
+    audio_kernels_scalar.copy_every_other(dst + i, src + 2*i, count - i);
+}
+
+static TARGET_AVX2 void interleave_avx2(int16_t* dst, const int16_t* left, const int16_t* right, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i l = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(left + i)), 0xd8);
+        __m256i r = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(right + i)), 0xd8);
+
+        _mm256_storeu_si256((__m256i*)(dst + 2*i),
+                _mm256_shuffle_epi32(_mm256_unpacklo_epi16(r, l), 0xb1));
+        _mm256_storeu_si256((__m256i*)(dst + 2*i + LANES),
+                _mm256_shuffle_epi32(_mm256_unpackhi_epi16(r, l), 0xb1));
+    }
+
+    audio_kernels_scalar.interleave(dst + 2*i, left + i, right + i, count - i);
+}
+
+static inline TARGET_AVX2 __m256i mp3_mul(__m256i x, __m256i c)
+{
+    return _mm256_srai_epi32(_mm256_mullo_epi32(x, c), 16);
+}
+
+static TARGET_AVX2 void mp3_butterflies_avx2(int32_t* v)
+{
+    const __m256i lut2 = _mm256_setr_epi32(0xFEC4, 0xF4FA, 0xC5E4, 0xE1C4,
+                                           0x1916, 0x4A50, 0xA268, 0x78AE);
+    const __m256i lut3 = _mm256_setr_epi32(0xFB14, 0xD4DC, 0x31F2, 0x8E3A,
+                                           0xFB14, 0xD4DC, 0x31F2, 0x8E3A);
+    const __m256i lut4 = _mm256_setr_epi32(0xEC84, 0x61F8, 0xEC84, 0x61F8,
+                                           0xEC84, 0x61F8, 0xEC84, 0x61F8);
+    __m256i a = _mm256_loadu_si256((const __m256i*)(v + 0));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(v + 8));
+    __m256i s, d, x, y;
+
+    /* 8-wide butterflies */
+    s = _mm256_add_epi32(a, b);
+    d = mp3_mul(_mm256_sub_epi32(a, b), lut2);
+
+    /* 4-wide butterflies, of both s and d at once */
+    x = _mm256_permute2x128_si256(s, d, 0x20);
+    y = _mm256_permute2x128_si256(s, d, 0x31);
+    s = _mm256_add_epi32(x, y);
+    d = mp3_mul(_mm256_sub_epi32(x, y), lut3);
+    a = _mm256_permute2x128_si256(s, d, 0x20);
+    b = _mm256_permute2x128_si256(s, d, 0x31);
+
+    _mm256_storeu_si256((__m256i*)(v + 0), a);
+    _mm256_storeu_si256((__m256i*)(v + 8), b);
+
+    /* 2-wide butterflies, within each group of 4 values */
+    x = _mm256_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+    y = _mm256_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2));
+    _mm256_storeu_si256((__m256i*)(v + 16), _mm256_unpacklo_epi64(
+                _mm256_add_epi32(a, x), mp3_mul(_mm256_sub_epi32(a, x), lut4)));
+    _mm256_storeu_si256((__m256i*)(v + 24), _mm256_unpacklo_epi64(
+                _mm256_add_epi32(b, y), mp3_mul(_mm256_sub_epi32(b, y), lut4)));
+}
+
+static TARGET_AVX2 void mp3_scale_avx2(int32_t* v, const uint16_t* scales, const int32_t* doubled, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m256i c = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(scales + i)));
+        __m256i x = mp3_mul(_mm256_loadu_si256((const __m256i*)(v + i)), c);
+
+        _mm256_storeu_si256((__m256i*)(v + i), _mm256_add_epi32(x,
+                    _mm256_and_si256(x, _mm256_loadu_si256((const __m256i*)(doubled + i)))));
+    }
+
+    audio_kernels_scalar.mp3_scale(v + i, scales + i, doubled + i, count - i);
+}
+
+/* rounded products of the 16 taps of one output, summed into 8 partial sums */
+static inline TARGET_AVX2 __m256i window_taps(const int16_t* x, const int16_t* h,
+                                              __m256i round, __m256i signs)
+{
+    __m256i p0, p1;
+
+    mul_32(_mm256_loadu_si256((const __m256i*)x), _mm256_loadu_si256((const __m256i*)h),
+           round, &p0, &p1);
+
+    p0 = _mm256_sub_epi32(_mm256_xor_si256(_mm256_srai_epi32(p0, 15), signs), signs);
+    p1 = _mm256_sub_epi32(_mm256_xor_si256(_mm256_srai_epi32(p1, 15), signs), signs);
+
+    return _mm256_add_epi32(p0, p1);
+}
+
+/* partial sums of 4 outputs, each 128-bit lane holding half of them */
+static inline TARGET_AVX2 __m256i window_sums(const int16_t** x, ptrdiff_t x_stride,
+                                              const int16_t** h, ptrdiff_t h_stride,
+                                              __m256i round, __m256i signs)
+{
+    __m256i s[4];
+    size_t k;
+
+    for (k = 0; k < 4; ++k, *x += x_stride, *h += h_stride)
+        s[k] = window_taps(*x, *h, round, signs);
+
+    return hadd_pairs(hadd_pairs(s[0], s[1]), hadd_pairs(s[2], s[3]));
+}
+
+static TARGET_AVX2 void mp3_window_avx2(int32_t* dst, const int16_t* x, ptrdiff_t x_stride,
+                                        const int16_t* h, ptrdiff_t h_stride, size_t count, int alternate)
+{
+    const __m256i round = _mm256_set1_epi32(0x4000);
+    const __m256i signs = alternate
+        ? _mm256_setr_epi32(0, -1, 0, -1, 0, -1, 0, -1)
+        : _mm256_setzero_si256();
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m256i lo = window_sums(&x, x_stride, &h, h_stride, round, signs);
+        __m256i hi = window_sums(&x, x_stride, &h, h_stride, round, signs);
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(
+                    _mm256_permute2x128_si256(lo, hi, 0x20),
+                    _mm256_permute2x128_si256(lo, hi, 0x31)));
+    }
+
+    audio_kernels_scalar.mp3_window(dst + i, x, x_stride, h, h_stride, count - i, alternate);
+}
+
+/* envelopes of samples 0-3 and 8-11 (e0), 4-7 and 12-15 (e1) of a block,
+ * starting from env: vpackssdw then yields them in sample order */
+static inline TARGET_AVX2 void envelope_ramps(int32_t env, int32_t step, __m256i* e0, __m256i* e1)
+{
+    const __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 8, 9, 10, 11);
+    const __m256i s = _mm256_set1_epi32(step);
+
+    *e0 = _mm256_add_epi32(_mm256_set1_epi32(env), _mm256_mullo_epi32(index, s));
+    *e1 = _mm256_add_epi32(*e0, _mm256_slli_epi32(s, 2));
+}
+
+/* (v * (env >> 16)) >> 15 for 16 samples, as outputs 0-3 and 8-11 (p0),
+ * 4-7 and 12-15 (p1) */
+static inline TARGET_AVX2 void musyx_env_products(__m256i v, __m256i e0, __m256i e1,
+                                                  __m256i* p0, __m256i* p1)
+{
+    __m256i gain = _mm256_packs_epi32(_mm256_srai_epi32(e0, 16), _mm256_srai_epi32(e1, 16));
+
+    mul_32(v, gain, _mm256_setzero_si256(), p0, p1);
+    *p0 = _mm256_srai_epi32(*p0, 15);
+    *p1 = _mm256_srai_epi32(*p1, 15);
+}
+
+static TARGET_AVX2 void musyx_envmix_avx2(int16_t* const* dst, const int16_t* v, size_t count,
+                                          int32_t* env, const int32_t* env_step)
+{
+    int16_t* tails[4];
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        const __m256i step = _mm256_set1_epi32((int32_t)((uint32_t)env_step[k] * LANES));
+        __m256i e0, e1;
+
+        envelope_ramps(env[k], env_step[k], &e0, &e1);
+
+        for (i = 0; i + LANES <= count; i += LANES) {
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst[k] + i));
+            __m256i p0, p1;
+
+            musyx_env_products(_mm256_loadu_si256((const __m256i*)(v + i)), e0, e1, &p0, &p1);
+            _mm256_storeu_si256((__m256i*)(dst[k] + i), _mm256_packs_epi32(
+                        _mm256_add_epi32(widen_lo(d), p0), _mm256_add_epi32(widen_hi(d), p1)));
+
+            e0 = _mm256_add_epi32(e0, step);
+            e1 = _mm256_add_epi32(e1, step);
+        }
+
+        env[k] = _mm_cvtsi128_si32(_mm256_castsi256_si128(e0));
+        tails[k] = dst[k] + i;
+    }
+
+    audio_kernels_scalar.musyx_envmix(tails, v + i, count - i, env, env_step);
+}
+
+static TARGET_AVX2 void musyx_envmix_wide_avx2(int32_t* const* dst, const int16_t* v, size_t count,
+                                               int32_t* env, const int32_t* env_step)
+{
+    int32_t* tails[4];
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        const __m256i step = _mm256_set1_epi32((int32_t)((uint32_t)env_step[k] * LANES));
+        __m256i e0, e1;
+
+        envelope_ramps(env[k], env_step[k], &e0, &e1);
+
+        for (i = 0; i + LANES <= count; i += LANES) {
+            __m256i p0, p1;
+
+            musyx_env_products(_mm256_loadu_si256((const __m256i*)(v + i)), e0, e1, &p0, &p1);
+            _mm256_storeu_si256((__m256i*)(dst[k] + i), _mm256_add_epi32(
+                        _mm256_loadu_si256((const __m256i*)(dst[k] + i)),
+                        _mm256_permute2x128_si256(p0, p1, 0x20)));
+            _mm256_storeu_si256((__m256i*)(dst[k] + i + 8), _mm256_add_epi32(
+                        _mm256_loadu_si256((const __m256i*)(dst[k] + i + 8)),
+                        _mm256_permute2x128_si256(p0, p1, 0x31)));
+
+            e0 = _mm256_add_epi32(e0, step);
+            e1 = _mm256_add_epi32(e1, step);
+        }
+
+        env[k] = _mm_cvtsi128_si32(_mm256_castsi256_si128(e0));
+        tails[k] = dst[k] + i;
+    }
+
+    audio_kernels_scalar.musyx_envmix_wide(tails, v + i, count - i, env, env_step);
+}
+
+/* see swap_pairs in audio_kernels_sse2.c */
+static inline TARGET_AVX2 __m256i swap_pairs(__m256i x)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xb1), 0xb1);
+}
+
+static TARGET_AVX2 void musyx_sfx_taps_avx2(int16_t* dst, const int16_t* const* taps, const int16_t* gains,
+                                            size_t tap_count, size_t count)
+{
+    const __m256i round = _mm256_set1_epi32(0x4000);
+    const int16_t* tails[8];
+    __m256i vgains[8];
+    size_t i, k;
+
+    for (k = 0; k < tap_count; ++k)
+        vgains[k] = _mm256_set1_epi16(gains[k]);
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+        for (k = 0; k < tap_count; ++k) {
+            __m256i p0, p1;
+
+            mul_32(swap_pairs(_mm256_loadu_si256((const __m256i*)(taps[k] + i))), vgains[k], round, &p0, &p1);
+            p0 = _mm256_add_epi32(_mm256_srai_epi32(p0, 15), widen_lo(d));
+            p1 = _mm256_add_epi32(_mm256_srai_epi32(p1, 15), widen_hi(d));
+            d = _mm256_packs_epi32(p0, p1);
+        }
+
+        _mm256_storeu_si256((__m256i*)(dst + i), d);
+    }
+
+    for (k = 0; k < tap_count; ++k)
+        tails[k] = taps[k] + i;
+
+    audio_kernels_scalar.musyx_sfx_taps(dst + i, tails, gains, tap_count, count - i);
+}
+
+/* in-lane pairs of src, as in musyx_fir4_sse2 */
+static TARGET_AVX2 void musyx_fir4_avx2(int16_t* dst, const int16_t* src, size_t count, const int32_t* h)
+{
+    __m256i h01, h23;
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        if (h[k] != (int16_t)h[k]) {
+            audio_kernels_scalar.musyx_fir4(dst, src, count, h);
+            return;
+        }
+    }
+
+    h01 = set1_pair((int16_t)h[0], (int16_t)h[1]);
+    h23 = set1_pair((int16_t)h[2], (int16_t)h[3]);
+
+    for (; i + LANES <= count; i += LANES) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)(src + i + 1));
+        __m256i x2 = _mm256_loadu_si256((const __m256i*)(src + i + 2));
+        __m256i x3 = _mm256_loadu_si256((const __m256i*)(src + i + 3));
+        __m256i d  = _mm256_loadu_si256((const __m256i*)(dst + i));
+
+        __m256i p0 = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(x0, x1), h01),
+                                   _mm256_madd_epi16(_mm256_unpacklo_epi16(x2, x3), h23));
+        __m256i p1 = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(x0, x1), h01),
+                                   _mm256_madd_epi16(_mm256_unpackhi_epi16(x2, x3), h23));
+
+        p0 = _mm256_add_epi32(_mm256_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm256_add_epi32(_mm256_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.musyx_fir4(dst + i, src + i, count - i, h);
+}
+
+const struct audio_kernels_t audio_kernels_avx2 =
+{
+    mix_avx2,
+    mix_round_avx2,
+    mix_high_avx2,
+    mix_gains_avx2,
+    add_avx2,
+    mult_q44_avx2,
+    overload_avx2,
+    dot4_avx2,
+    dot4_sat_avx2,
+    fir4_avx2,
+    fir4_sat_avx2,
+    envmix_nead_avx2,
+    filter_avx2,
+    adpcm_residuals_avx2,
+    polef_avx2,
+    iirf_fir_avx2,
+    adpcm_expand_4bits_avx2,
+    adpcm_expand_2bits_avx2,
+    copy_every_other_avx2,
+    interleave_avx2,
+    mp3_butterflies_avx2,
+    mp3_scale_avx2,
+    mp3_window_avx2,
+    musyx_envmix_avx2,
+    musyx_envmix_wide_avx2,
+    musyx_sfx_taps_avx2,
+    musyx_fir4_avx2
+};
+
+#endif
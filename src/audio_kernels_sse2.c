@@ -0,0 +1,892 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_kernels_sse2.c                            *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <string.h>
+
+#include "audio_kernels.h"
+
+#ifdef AUDIO_KERNELS_X86
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define TARGET_SSE2
+#endif
+
+enum { LANES = 8 };
+
+/* sign extend the 8 samples of x into two vectors of 32-bit values */
+static inline TARGET_SSE2 __m128i widen_lo(__m128i x)
+{
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+static inline TARGET_SSE2 __m128i widen_hi(__m128i x)
+{
+    return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+/* compute the 32-bit products of x and y and add round to each of them */
+static inline TARGET_SSE2 void mul_32(__m128i x, __m128i y, __m128i round,
+                                      __m128i* p0, __m128i* p1)
+{
+    __m128i lo = _mm_mullo_epi16(x, y);
+    __m128i hi = _mm_mulhi_epi16(x, y);
+
+    *p0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round);
+    *p1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round);
+}
+
+/* (x * gain) >> 16 for an unsigned gain: pmulhw sees gain - 0x10000 when
+ * the top bit is set, which must be compensated by adding x back */
+static inline TARGET_SSE2 __m128i mul_high_u16(__m128i x, __m128i gain, __m128i fix_mask)
+{
+    return _mm_add_epi16(_mm_mulhi_epi16(x, gain), _mm_and_si128(x, fix_mask));
+}
+
+/* pmulhrsw is not used for mix_round: besides requiring SSSE3, it does not
+ * match the scalar code for -32768 * -32768, so products are computed on
+ * 32 bits and saturated back with packssdw */
+static TARGET_SSE2 void mix_rounded(int16_t* dst, const int16_t* src, size_t count,
+                                    int16_t gain, int32_t round)
+{
+    const __m128i vgain  = _mm_set1_epi16(gain);
+    const __m128i vround = _mm_set1_epi32(round);
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i p0, p1;
+
+        mul_32(s, vgain, vround, &p0, &p1);
+        p0 = _mm_add_epi32(_mm_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm_add_epi32(_mm_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+
+    if (round == 0)
+        audio_kernels_scalar.mix(dst + i, src + i, count - i, gain);
+    else
+        audio_kernels_scalar.mix_round(dst + i, src + i, count - i, gain);
+}
+
+static TARGET_SSE2 void mix_sse2(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    if (audio_kernels_overlap(dst, src, LANES))
+        audio_kernels_scalar.mix(dst, src, count, gain);
+    else
+        mix_rounded(dst, src, count, gain, 0);
+}
+
+static TARGET_SSE2 void mix_round_sse2(int16_t* dst, const int16_t* src, size_t count, int16_t gain)
+{
+    if (audio_kernels_overlap(dst, src, LANES))
+        audio_kernels_scalar.mix_round(dst, src, count, gain);
+    else
+        mix_rounded(dst, src, count, gain, 0x4000);
+}
+
+static TARGET_SSE2 void mix_high_sse2(int16_t* dst, const int16_t* src, size_t count, uint16_t gain)
+{
+    const __m128i vgain = _mm_set1_epi16((int16_t)gain);
+    const __m128i fix   = _mm_set1_epi16((gain & 0x8000) ? -1 : 0);
+    size_t i = 0;
+
+    if (!audio_kernels_overlap(dst, src, LANES)) {
+        for (; i + LANES <= count; i += LANES) {
+            __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+            d = _mm_adds_epi16(d, mul_high_u16(s, vgain, fix));
+            _mm_storeu_si128((__m128i*)(dst + i), d);
+        }
+    }
+
+    audio_kernels_scalar.mix_high(dst + i, src + i, count - i, gain);
+}
+
+static TARGET_SSE2 void mix_gains_sse2(int16_t* dst, const int16_t* src, const int16_t* gains, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i g = _mm_loadu_si128((const __m128i*)(gains + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i p0, p1;
+
+        mul_32(s, g, _mm_setzero_si128(), &p0, &p1);
+        p0 = _mm_add_epi32(_mm_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm_add_epi32(_mm_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.mix_gains(dst + i, src + i, gains + i, count - i);
+}
+
+static TARGET_SSE2 void add_sse2(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i = 0;
+
+    if (!audio_kernels_overlap(dst, src, LANES)) {
+        for (; i + LANES <= count; i += LANES) {
+            __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(d, s));
+        }
+    }
+
+    audio_kernels_scalar.add(dst + i, src + i, count - i);
+}
+
+static TARGET_SSE2 void mult_q44_sse2(int16_t* dst, size_t count, int8_t gain)
+{
+    const __m128i vgain = _mm_set1_epi16(gain);
+    const __m128i zero  = _mm_setzero_si128();
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i p0, p1;
+
+        mul_32(d, vgain, zero, &p0, &p1);
+        p0 = _mm_srai_epi32(p0, 4);
+        p1 = _mm_srai_epi32(p1, 4);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.mult_q44(dst + i, count - i, gain);
+}
+
+static TARGET_SSE2 void overload_sse2(int16_t* dst, size_t count, int16_t gain, uint16_t attenuation)
+{
+    const __m128i vgain  = _mm_set1_epi16(gain);
+    const __m128i vatten = _mm_set1_epi16((int16_t)attenuation);
+    const __m128i fix    = _mm_set1_epi16((attenuation & 0x8000) ? -1 : 0);
+    const __m128i zero   = _mm_setzero_si128();
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i p0, p1;
+
+        mul_32(d, vgain, zero, &p0, &p1);
+        d = mul_high_u16(_mm_packs_epi32(p0, p1), vatten, fix);
+
+        _mm_storeu_si128((__m128i*)(dst + i), d);
+    }
+
+    audio_kernels_scalar.overload(dst + i, count - i, gain, attenuation);
+}
+
+/* pick 32-bit elements out of a and b, as shufps does */
+#define SHUFFLE_PAIR(a, b, imm) \
+    _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), imm))
+
+/* sums the 32-bit products of 4 outputs held by two pmaddwd results */
+static inline TARGET_SSE2 __m128i hadd_pairs(__m128i m0, __m128i m1)
+{
+    return _mm_add_epi32(SHUFFLE_PAIR(m0, m1, _MM_SHUFFLE(2, 0, 2, 0)),
+                         SHUFFLE_PAIR(m0, m1, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+/* accumulates with saturation the 4 taps of the 2 outputs held by p
+ * and returns both sign extended into the odd 32-bit elements */
+static inline TARGET_SSE2 __m128i sat_sum4(__m128i p)
+{
+    __m128i accu = _mm_adds_epi16(p, _mm_srli_epi64(p, 16));
+    accu = _mm_adds_epi16(accu, _mm_srli_epi64(p, 32));
+    accu = _mm_adds_epi16(accu, _mm_srli_epi64(p, 48));
+
+    return _mm_srai_epi32(_mm_slli_epi64(accu, 48), 16);
+}
+
+/* (x * h) >> 15, which fits in 16 bits as long as h is not -32768 */
+static inline TARGET_SSE2 __m128i mul_q15(__m128i x, __m128i h)
+{
+    return _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(x, h), 1),
+                        _mm_srli_epi16(_mm_mullo_epi16(x, h), 15));
+}
+
+static TARGET_SSE2 void dot4_sse2(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    __m128i m[4];
+    size_t i, k;
+
+    for (i = 0; i + LANES <= count; i += LANES, x += 4 * LANES, h += 4 * LANES) {
+        for (k = 0; k < 4; ++k)
+            m[k] = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(x + 8 * k)),
+                                  _mm_loadu_si128((const __m128i*)(h + 8 * k)));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(
+                    _mm_srai_epi32(hadd_pairs(m[0], m[1]), 15),
+                    _mm_srai_epi32(hadd_pairs(m[2], m[3]), 15)));
+    }
+
+    audio_kernels_scalar.dot4(dst + i, x, h, count - i);
+}
+
+static TARGET_SSE2 void dot4_sat_sse2(int16_t* dst, const int16_t* x, const int16_t* h, size_t count)
+{
+    __m128i m[4];
+    size_t i, k;
+
+    for (i = 0; i + LANES <= count; i += LANES, x += 4 * LANES, h += 4 * LANES) {
+        for (k = 0; k < 4; ++k)
+            m[k] = sat_sum4(mul_q15(_mm_loadu_si128((const __m128i*)(x + 8 * k)),
+                                    _mm_loadu_si128((const __m128i*)(h + 8 * k))));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(
+                    SHUFFLE_PAIR(m[0], m[1], _MM_SHUFFLE(3, 1, 3, 1)),
+                    SHUFFLE_PAIR(m[2], m[3], _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    audio_kernels_scalar.dot4_sat(dst + i, x, h, count - i);
+}
+
+static TARGET_SSE2 void fir4_sse2(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    __m128i vh[4];
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k)
+        vh[k] = _mm_set1_epi16(h[k]);
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i p0, p1, q0, q1;
+
+        mul_32(_mm_loadu_si128((const __m128i*)(src + i)), vh[0], _mm_setzero_si128(), &p0, &p1);
+        for (k = 1; k < 4; ++k) {
+            mul_32(_mm_loadu_si128((const __m128i*)(src + i + k)), vh[k], _mm_setzero_si128(), &q0, &q1);
+            p0 = _mm_add_epi32(p0, q0);
+            p1 = _mm_add_epi32(p1, q1);
+        }
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(
+                    _mm_srai_epi32(p0, 15), _mm_srai_epi32(p1, 15)));
+    }
+
+    audio_kernels_scalar.fir4(dst + i, src + i, count - i, h);
+}
+
+static TARGET_SSE2 void fir4_sat_sse2(int16_t* dst, const int16_t* src, size_t count, const int16_t* h)
+{
+    __m128i vh[4];
+    size_t i, k;
+
+    for (k = 0; k < 4; ++k)
+        vh[k] = _mm_set1_epi16(h[k]);
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i accu = mul_q15(_mm_loadu_si128((const __m128i*)(src + i)), vh[0]);
+
+        for (k = 1; k < 4; ++k)
+            accu = _mm_adds_epi16(accu, mul_q15(_mm_loadu_si128((const __m128i*)(src + i + k)), vh[k]));
+
+        _mm_storeu_si128((__m128i*)(dst + i), accu);
+    }
+
+    audio_kernels_scalar.fir4_sat(dst + i, src + i, count - i, h);
+}
+
+/* the unsigned gains of the 8 samples are held by the 16-bit lanes of env,
+ * whose sign bits give the mul_high_u16 fix mask */
+static inline TARGET_SSE2 __m128i mul_env(__m128i x, __m128i env)
+{
+    return mul_high_u16(x, env, _mm_srai_epi16(env, 15));
+}
+
+/* accumulates x into 8 samples of dst. Buffers are loaded and stored one at a
+ * time so that coinciding buffers accumulate in turn, as in the scalar code */
+static inline TARGET_SSE2 void accumulate(int16_t* dst, __m128i x)
+{
+    _mm_storeu_si128((__m128i*)dst, _mm_adds_epi16(_mm_loadu_si128((const __m128i*)dst), x));
+}
+
+static TARGET_SSE2 void envmix_nead_sse2(int16_t* const* buffers, const int16_t* in, size_t count,
+                                         uint16_t* env_values, const uint16_t* env_steps, const int16_t* xors)
+{
+    const __m128i xor_l  = _mm_set1_epi16(xors[0]);
+    const __m128i xor_r  = _mm_set1_epi16(xors[1]);
+    const __m128i xor_l2 = _mm_set1_epi16(xors[2]);
+    const __m128i xor_r2 = _mm_set1_epi16(xors[3]);
+    size_t i;
+
+    for (i = 0; i < count; i += LANES) {
+        __m128i x    = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i env2 = _mm_set1_epi16((int16_t)env_values[2]);
+        __m128i l    = _mm_xor_si128(mul_env(x, _mm_set1_epi16((int16_t)env_values[0])), xor_l);
+        __m128i r    = _mm_xor_si128(mul_env(x, _mm_set1_epi16((int16_t)env_values[1])), xor_r);
+
+        accumulate(buffers[0] + i, l);
+        accumulate(buffers[1] + i, r);
+        accumulate(buffers[2] + i, _mm_xor_si128(mul_env(l, env2), xor_l2));
+        accumulate(buffers[3] + i, _mm_xor_si128(mul_env(r, env2), xor_r2));
+
+        env_values[0] += env_steps[0];
+        env_values[1] += env_steps[1];
+        env_values[2] += env_steps[2];
+    }
+}
+
+/* Coefficients of the FILTER command as a matrix mapping the 16 samples of
+ * the history and current blocks to the 8 outputs, stored by column pairs
+ * like the ADPCM matrices: output r, with logical index r^1, takes lut[(7-k)^1]
+ * times the sample k + 1 positions after its own in the previous block */
+static TARGET_SSE2 void filter_matrix(int16_t* matrix, const int16_t* lut)
+{
+    unsigned r, k;
+
+    memset(matrix, 0, 128 * sizeof(matrix[0]));
+
+    for (r = 0; r < 8; ++r) {
+        for (k = 0; k < 8; ++k) {
+            unsigned column = ((r ^ 1) + 1 + k) ^ 1;
+
+            matrix[16 * (column >> 1) + 2 * r + (column & 1)] = lut[(7 - k) ^ 1];
+        }
+    }
+}
+
+/* accumulates the products of the 4 column pairs of matrix with the
+ * corresponding sample pairs of x into the outputs 0-3 (lo) and 4-7 (hi) */
+static inline TARGET_SSE2 void filter_columns(__m128i x, const int16_t* matrix, __m128i* lo, __m128i* hi)
+{
+    __m128i pairs[4];
+    unsigned p;
+
+    pairs[0] = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 0, 0, 0));
+    pairs[1] = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 1, 1, 1));
+    pairs[2] = _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 2, 2, 2));
+    pairs[3] = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+
+    for (p = 0; p < 4; ++p, matrix += 16) {
+        *lo = _mm_add_epi32(*lo, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)matrix), pairs[p]));
+        *hi = _mm_add_epi32(*hi, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(matrix + 8)), pairs[p]));
+    }
+}
+
+/* keeps the low 16 bits of each (x + 0x4000) >> 15, sign extended
+ * so that packssdw does not saturate them */
+static inline TARGET_SSE2 __m128i round_truncate(__m128i x)
+{
+    x = _mm_srai_epi32(_mm_add_epi32(x, _mm_set1_epi32(0x4000)), 15);
+    return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+static TARGET_SSE2 void filter_sse2(int16_t* samples, int16_t* history, size_t blocks, const int16_t* lut)
+{
+    int16_t matrix[128];
+    __m128i previous = _mm_loadu_si128((const __m128i*)history);
+    size_t i;
+
+    filter_matrix(matrix, lut);
+
+    for (i = 0; i < blocks; ++i, samples += 8) {
+        __m128i current = _mm_loadu_si128((const __m128i*)samples);
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+
+        filter_columns(previous, matrix, &lo, &hi);
+        filter_columns(current, matrix + 64, &lo, &hi);
+
+        _mm_storeu_si128((__m128i*)samples, _mm_packs_epi32(round_truncate(lo), round_truncate(hi)));
+        previous = current;
+    }
+
+    _mm_storeu_si128((__m128i*)history, previous);
+}
+
+/* broadcast the (a, b) pair of samples to every 32-bit element */
+static inline TARGET_SSE2 __m128i set1_pair(int16_t a, int16_t b)
+{
+    return _mm_set1_epi32((int32_t)(uint16_t)a | ((int32_t)(uint16_t)b << 16));
+}
+
+/* products of an 8x10 matrix stored by column pairs with (l1, l2, src[0..7]),
+ * as outputs 0-3 (lo) and 4-7 (hi) */
+static inline TARGET_SSE2 void matrix_products(const int16_t* src, const int16_t* matrix,
+                                               const int16_t* last_samples, __m128i* lo, __m128i* hi)
+{
+    size_t p;
+
+    *lo = _mm_setzero_si128();
+    *hi = _mm_setzero_si128();
+
+    for (p = 0; p < 5; ++p, matrix += 16) {
+        __m128i v = (p == 0)
+            ? set1_pair(last_samples[0], last_samples[1])
+            : set1_pair(src[2 * p - 2], src[2 * p - 1]);
+
+        *lo = _mm_add_epi32(*lo, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)matrix), v));
+        *hi = _mm_add_epi32(*hi, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(matrix + 8)), v));
+    }
+}
+
+static TARGET_SSE2 void adpcm_residuals_sse2(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                                             const int16_t* last_samples, size_t count)
+{
+    int16_t outputs[8];
+    __m128i lo, hi;
+
+    matrix_products(src, matrix, last_samples, &lo, &hi);
+
+    _mm_storeu_si128((__m128i*)outputs, _mm_packs_epi32(
+                _mm_srai_epi32(lo, 11), _mm_srai_epi32(hi, 11)));
+    memcpy(dst, outputs, count * sizeof(dst[0]));
+}
+
+static TARGET_SSE2 void polef_sse2(int16_t* dst, const int16_t* src, const int16_t* matrix,
+                                   const int16_t* last_samples, uint16_t gain)
+{
+    __m128i lo, hi;
+
+    matrix_products(src, matrix, last_samples, &lo, &hi);
+
+    /* gains from 0x8000 were stored as gain - 0x10000 */
+    if (gain & 0x8000) {
+        __m128i x = _mm_loadu_si128((const __m128i*)src);
+
+        lo = _mm_add_epi32(lo, _mm_slli_epi32(widen_lo(x), 16));
+        hi = _mm_add_epi32(hi, _mm_slli_epi32(widen_hi(x), 16));
+    }
+
+    _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(
+                _mm_srai_epi32(lo, 14), _mm_srai_epi32(hi, 14)));
+}
+
+static TARGET_SSE2 void iirf_fir_sse2(int32_t* dst, const int16_t* src, size_t count, int16_t h0, int16_t h1)
+{
+    const __m128i vh0   = _mm_set1_epi16(h0);
+    const __m128i vh1   = _mm_set1_epi16(h1);
+    const __m128i round = _mm_set1_epi32(0x4000);
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i p0, p1, q0, q1;
+
+        /* each vmulf is rounded on its own */
+        mul_32(_mm_loadu_si128((const __m128i*)(src + i + 2)), vh0, round, &p0, &p1);
+        p0 = _mm_srai_epi32(p0, 15);
+        p1 = _mm_srai_epi32(p1, 15);
+
+        mul_32(_mm_loadu_si128((const __m128i*)(src + i + 1)), vh1, round, &q0, &q1);
+        p0 = _mm_add_epi32(p0, _mm_srai_epi32(q0, 15));
+        p1 = _mm_add_epi32(p1, _mm_srai_epi32(q1, 15));
+
+        mul_32(_mm_loadu_si128((const __m128i*)(src + i)), vh0, round, &q0, &q1);
+        p0 = _mm_add_epi32(p0, _mm_srai_epi32(q0, 15));
+        p1 = _mm_add_epi32(p1, _mm_srai_epi32(q1, 15));
+
+        _mm_storeu_si128((__m128i*)(dst + i), p0);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), p1);
+    }
+
+    audio_kernels_scalar.iirf_fir(dst + i, src + i, count - i, h0, h1);
+}
+
+/* Each sample is expanded from a copy of its byte held in the upper half of
+ * a 16-bit lane: multiplying by a power of two brings the sample bits to the
+ * top of the lane, masking clears the others and the arithmetic shift then
+ * sign extends and scales it. */
+static TARGET_SSE2 void adpcm_expand_4bits_sse2(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(rshift);
+    const __m128i scale = _mm_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16);
+    const __m128i mask  = _mm_set1_epi16((int16_t)0xf000);
+    __m128i bytes = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64((const __m128i*)src));
+    __m128i lo = _mm_unpacklo_epi16(bytes, bytes);
+    __m128i hi = _mm_unpackhi_epi16(bytes, bytes);
+
+    lo = _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(lo, scale), mask), shift);
+    hi = _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(hi, scale), mask), shift);
+
+    _mm_storeu_si128((__m128i*)dst, lo);
+    _mm_storeu_si128((__m128i*)(dst + 8), hi);
+}
+
+static TARGET_SSE2 void adpcm_expand_2bits_sse2(int16_t* dst, const uint8_t* src, unsigned rshift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(rshift);
+    const __m128i scale = _mm_setr_epi16(1, 4, 16, 64, 1, 4, 16, 64);
+    const __m128i mask  = _mm_set1_epi16((int16_t)0xc000);
+    __m128i bytes, pairs, lo, hi;
+    int32_t payload;
+
+    memcpy(&payload, src, sizeof(payload));
+
+    bytes = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_cvtsi32_si128(payload));
+    pairs = _mm_unpacklo_epi16(bytes, bytes);
+    lo = _mm_unpacklo_epi32(pairs, pairs);
+    hi = _mm_unpackhi_epi32(pairs, pairs);
+
+    lo = _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(lo, scale), mask), shift);
+    hi = _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(hi, scale), mask), shift);
+
+    _mm_storeu_si128((__m128i*)dst, lo);
+    _mm_storeu_si128((__m128i*)(dst + 8), hi);
+}
+
+/* x86 is little endian: even samples sit in the high halves of DMEM pairs
+ * and are swapped back into place after packing */
+static TARGET_SSE2 void copy_every_other_sse2(int16_t* dst, const int16_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i a = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(src + 2*i)), 16);
+        __m128i b = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(src + 2*i + LANES)), 16);
+        __m128i x = _mm_packs_epi32(a, b);
+
+        x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xb1), 0xb1);
+        _mm_storeu_si128((__m128i*)(dst + i), x);
+    }
+
+    audio_kernels_scalar.copy_every_other(dst + i, src + 2*i, count - i);
+}
+
+/* interleaving pair-swapped channels gives (r1, l1, r0, l0) groups */
+static TARGET_SSE2 void interleave_sse2(int16_t* dst, const int16_t* left, const int16_t* right, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+
+        _mm_storeu_si128((__m128i*)(dst + 2*i),
+                _mm_shuffle_epi32(_mm_unpacklo_epi16(r, l), 0xb1));
+        _mm_storeu_si128((__m128i*)(dst + 2*i + LANES),
+                _mm_shuffle_epi32(_mm_unpackhi_epi16(r, l), 0xb1));
+    }
+
+    audio_kernels_scalar.interleave(dst + 2*i, left + i, right + i, count - i);
+}
+
+/* wrapping 32-bit products, pmulld being SSE4.1 */
+static inline TARGET_SSE2 __m128i mullo_32(__m128i x, __m128i y)
+{
+    __m128i even = _mm_mul_epu32(x, y);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline TARGET_SSE2 __m128i mp3_mul(__m128i x, __m128i c)
+{
+    return _mm_srai_epi32(mullo_32(x, c), 16);
+}
+
+/* 2-wide butterflies of the 4 values held by x */
+static inline TARGET_SSE2 __m128i mp3_butterflies_2(__m128i x, __m128i c)
+{
+    __m128i y = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+
+    return _mm_unpacklo_epi64(_mm_add_epi32(x, y), mp3_mul(_mm_sub_epi32(x, y), c));
+}
+
+static TARGET_SSE2 void mp3_butterflies_sse2(int32_t* v)
+{
+    const __m128i lut2_lo = _mm_setr_epi32(0xFEC4, 0xF4FA, 0xC5E4, 0xE1C4);
+    const __m128i lut2_hi = _mm_setr_epi32(0x1916, 0x4A50, 0xA268, 0x78AE);
+    const __m128i lut3    = _mm_setr_epi32(0xFB14, 0xD4DC, 0x31F2, 0x8E3A);
+    const __m128i lut4    = _mm_setr_epi32(0xEC84, 0x61F8, 0xEC84, 0x61F8);
+    __m128i a0 = _mm_loadu_si128((const __m128i*)(v + 0));
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(v + 4));
+    __m128i b0 = _mm_loadu_si128((const __m128i*)(v + 8));
+    __m128i b1 = _mm_loadu_si128((const __m128i*)(v + 12));
+    __m128i s0, s1, d0, d1;
+
+    /* 8-wide butterflies */
+    s0 = _mm_add_epi32(a0, b0);
+    s1 = _mm_add_epi32(a1, b1);
+    d0 = mp3_mul(_mm_sub_epi32(a0, b0), lut2_lo);
+    d1 = mp3_mul(_mm_sub_epi32(a1, b1), lut2_hi);
+
+    /* 4-wide butterflies */
+    a0 = _mm_add_epi32(s0, s1);
+    a1 = mp3_mul(_mm_sub_epi32(s0, s1), lut3);
+    b0 = _mm_add_epi32(d0, d1);
+    b1 = mp3_mul(_mm_sub_epi32(d0, d1), lut3);
+
+    _mm_storeu_si128((__m128i*)(v + 0),  a0);
+    _mm_storeu_si128((__m128i*)(v + 4),  a1);
+    _mm_storeu_si128((__m128i*)(v + 8),  b0);
+    _mm_storeu_si128((__m128i*)(v + 12), b1);
+
+    _mm_storeu_si128((__m128i*)(v + 16), mp3_butterflies_2(a0, lut4));
+    _mm_storeu_si128((__m128i*)(v + 20), mp3_butterflies_2(a1, lut4));
+    _mm_storeu_si128((__m128i*)(v + 24), mp3_butterflies_2(b0, lut4));
+    _mm_storeu_si128((__m128i*)(v + 28), mp3_butterflies_2(b1, lut4));
+}
+
+static TARGET_SSE2 void mp3_scale_sse2(int32_t* v, const uint16_t* scales, const int32_t* doubled, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        __m128i c = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(scales + i)),
+                                       _mm_setzero_si128());
+        __m128i x = mp3_mul(_mm_loadu_si128((const __m128i*)(v + i)), c);
+
+        _mm_storeu_si128((__m128i*)(v + i), _mm_add_epi32(x,
+                    _mm_and_si128(x, _mm_loadu_si128((const __m128i*)(doubled + i)))));
+    }
+
+    audio_kernels_scalar.mp3_scale(v + i, scales + i, doubled + i, count - i);
+}
+
+/* rounded products of the 16 taps of one output, summed into 4 partial sums */
+static inline TARGET_SSE2 __m128i window_taps(const int16_t* x, const int16_t* h,
+                                              __m128i round, __m128i signs)
+{
+    __m128i p[4];
+    size_t k;
+
+    mul_32(_mm_loadu_si128((const __m128i*)x), _mm_loadu_si128((const __m128i*)h),
+           round, &p[0], &p[1]);
+    mul_32(_mm_loadu_si128((const __m128i*)(x + 8)), _mm_loadu_si128((const __m128i*)(h + 8)),
+           round, &p[2], &p[3]);
+
+    for (k = 0; k < 4; ++k)
+        p[k] = _mm_sub_epi32(_mm_xor_si128(_mm_srai_epi32(p[k], 15), signs), signs);
+
+    return _mm_add_epi32(_mm_add_epi32(p[0], p[1]), _mm_add_epi32(p[2], p[3]));
+}
+
+static TARGET_SSE2 void mp3_window_sse2(int32_t* dst, const int16_t* x, ptrdiff_t x_stride,
+                                        const int16_t* h, ptrdiff_t h_stride, size_t count, int alternate)
+{
+    const __m128i round = _mm_set1_epi32(0x4000);
+    const __m128i signs = alternate ? _mm_setr_epi32(0, -1, 0, -1) : _mm_setzero_si128();
+    __m128i s[4];
+    size_t i, k;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        for (k = 0; k < 4; ++k, x += x_stride, h += h_stride)
+            s[k] = window_taps(x, h, round, signs);
+
+        _mm_storeu_si128((__m128i*)(dst + i),
+                hadd_pairs(hadd_pairs(s[0], s[1]), hadd_pairs(s[2], s[3])));
+    }
+
+    audio_kernels_scalar.mp3_window(dst + i, x, x_stride, h, h_stride, count - i, alternate);
+}
+
+/* envelopes of 4 consecutive samples, starting from env */
+static inline TARGET_SSE2 __m128i envelope_ramp(int32_t env, int32_t step)
+{
+    uint32_t e = (uint32_t)env;
+    uint32_t s = (uint32_t)step;
+
+    return _mm_setr_epi32((int32_t)e, (int32_t)(e + s), (int32_t)(e + 2 * s), (int32_t)(e + 3 * s));
+}
+
+/* (v * (env >> 16)) >> 15 for 8 samples, as outputs 0-3 (p0) and 4-7 (p1) */
+static inline TARGET_SSE2 void musyx_env_products(__m128i v, __m128i e0, __m128i e1,
+                                                  __m128i* p0, __m128i* p1)
+{
+    __m128i gain = _mm_packs_epi32(_mm_srai_epi32(e0, 16), _mm_srai_epi32(e1, 16));
+
+    mul_32(v, gain, _mm_setzero_si128(), p0, p1);
+    *p0 = _mm_srai_epi32(*p0, 15);
+    *p1 = _mm_srai_epi32(*p1, 15);
+}
+
+static TARGET_SSE2 void musyx_envmix_sse2(int16_t* const* dst, const int16_t* v, size_t count,
+                                          int32_t* env, const int32_t* env_step)
+{
+    int16_t* tails[4];
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        const __m128i step = _mm_set1_epi32((int32_t)((uint32_t)env_step[k] * LANES));
+        __m128i e0 = envelope_ramp(env[k], env_step[k]);
+        __m128i e1 = envelope_ramp((int32_t)((uint32_t)env[k] + (uint32_t)env_step[k] * 4), env_step[k]);
+
+        for (i = 0; i + LANES <= count; i += LANES) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst[k] + i));
+            __m128i p0, p1;
+
+            musyx_env_products(_mm_loadu_si128((const __m128i*)(v + i)), e0, e1, &p0, &p1);
+            _mm_storeu_si128((__m128i*)(dst[k] + i), _mm_packs_epi32(
+                        _mm_add_epi32(widen_lo(d), p0), _mm_add_epi32(widen_hi(d), p1)));
+
+            e0 = _mm_add_epi32(e0, step);
+            e1 = _mm_add_epi32(e1, step);
+        }
+
+        env[k] = _mm_cvtsi128_si32(e0);
+        tails[k] = dst[k] + i;
+    }
+
+    audio_kernels_scalar.musyx_envmix(tails, v + i, count - i, env, env_step);
+}
+
+static TARGET_SSE2 void musyx_envmix_wide_sse2(int32_t* const* dst, const int16_t* v, size_t count,
+                                               int32_t* env, const int32_t* env_step)
+{
+    int32_t* tails[4];
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        const __m128i step = _mm_set1_epi32((int32_t)((uint32_t)env_step[k] * LANES));
+        __m128i e0 = envelope_ramp(env[k], env_step[k]);
+        __m128i e1 = envelope_ramp((int32_t)((uint32_t)env[k] + (uint32_t)env_step[k] * 4), env_step[k]);
+
+        for (i = 0; i + LANES <= count; i += LANES) {
+            __m128i p0, p1;
+
+            musyx_env_products(_mm_loadu_si128((const __m128i*)(v + i)), e0, e1, &p0, &p1);
+            _mm_storeu_si128((__m128i*)(dst[k] + i),
+                    _mm_add_epi32(_mm_loadu_si128((const __m128i*)(dst[k] + i)), p0));
+            _mm_storeu_si128((__m128i*)(dst[k] + i + 4),
+                    _mm_add_epi32(_mm_loadu_si128((const __m128i*)(dst[k] + i + 4)), p1));
+
+            e0 = _mm_add_epi32(e0, step);
+            e1 = _mm_add_epi32(e1, step);
+        }
+
+        env[k] = _mm_cvtsi128_si32(e0);
+        tails[k] = dst[k] + i;
+    }
+
+    audio_kernels_scalar.musyx_envmix_wide(tails, v + i, count - i, env, env_step);
+}
+
+/* DRAM samples are pair-swapped, x86 being little endian */
+static inline TARGET_SSE2 __m128i swap_pairs(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xb1), 0xb1);
+}
+
+static TARGET_SSE2 void musyx_sfx_taps_sse2(int16_t* dst, const int16_t* const* taps, const int16_t* gains,
+                                            size_t tap_count, size_t count)
+{
+    const __m128i round = _mm_set1_epi32(0x4000);
+    const int16_t* tails[8];
+    __m128i vgains[8];
+    size_t i, k;
+
+    for (k = 0; k < tap_count; ++k)
+        vgains[k] = _mm_set1_epi16(gains[k]);
+
+    /* every tap gets mixed into the samples while they sit in a register */
+    for (i = 0; i + LANES <= count; i += LANES) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+        for (k = 0; k < tap_count; ++k) {
+            __m128i p0, p1;
+
+            mul_32(swap_pairs(_mm_loadu_si128((const __m128i*)(taps[k] + i))), vgains[k], round, &p0, &p1);
+            p0 = _mm_add_epi32(_mm_srai_epi32(p0, 15), widen_lo(d));
+            p1 = _mm_add_epi32(_mm_srai_epi32(p1, 15), widen_hi(d));
+            d = _mm_packs_epi32(p0, p1);
+        }
+
+        _mm_storeu_si128((__m128i*)(dst + i), d);
+    }
+
+    for (k = 0; k < tap_count; ++k)
+        tails[k] = taps[k] + i;
+
+    audio_kernels_scalar.musyx_sfx_taps(dst + i, tails, gains, tap_count, count - i);
+}
+
+/* pmaddwd sums the products of consecutive pairs of src with (h0, h1) and
+ * (h2, h3). It needs 16-bit coefficients, so 32768 (from -32768 * -32768)
+ * is left to the scalar code */
+static TARGET_SSE2 void musyx_fir4_sse2(int16_t* dst, const int16_t* src, size_t count, const int32_t* h)
+{
+    __m128i h01, h23;
+    size_t i = 0, k;
+
+    for (k = 0; k < 4; ++k) {
+        if (h[k] != (int16_t)h[k]) {
+            audio_kernels_scalar.musyx_fir4(dst, src, count, h);
+            return;
+        }
+    }
+
+    h01 = set1_pair((int16_t)h[0], (int16_t)h[1]);
+    h23 = set1_pair((int16_t)h[2], (int16_t)h[3]);
+
+    for (; i + LANES <= count; i += LANES) {
+        __m128i x0 = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(src + i + 1));
+        __m128i x2 = _mm_loadu_si128((const __m128i*)(src + i + 2));
+        __m128i x3 = _mm_loadu_si128((const __m128i*)(src + i + 3));
+        __m128i d  = _mm_loadu_si128((const __m128i*)(dst + i));
+
+        __m128i p0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x0, x1), h01),
+                                   _mm_madd_epi16(_mm_unpacklo_epi16(x2, x3), h23));
+        __m128i p1 = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x0, x1), h01),
+                                   _mm_madd_epi16(_mm_unpackhi_epi16(x2, x3), h23));
+
+        p0 = _mm_add_epi32(_mm_srai_epi32(p0, 15), widen_lo(d));
+        p1 = _mm_add_epi32(_mm_srai_epi32(p1, 15), widen_hi(d));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+
+    audio_kernels_scalar.musyx_fir4(dst + i, src + i, count - i, h);
+}
+
+const struct audio_kernels_t audio_kernels_sse2 =
+{
+    mix_sse2,
+    mix_round_sse2,
+    mix_high_sse2,
+    mix_gains_sse2,
+    add_sse2,
+    mult_q44_sse2,
+    overload_sse2,
+    dot4_sse2,
+    dot4_sat_sse2,
+    fir4_sse2,
+    fir4_sat_sse2,
+    envmix_nead_sse2,
+    filter_sse2,
+    adpcm_residuals_sse2,
+    polef_sse2,
+    iirf_fir_sse2,
+    adpcm_expand_4bits_sse2,
+    adpcm_expand_2bits_sse2,
+    copy_every_other_sse2,
+    interleave_sse2,
+    mp3_butterflies_sse2,
+    mp3_scale_sse2,
+    mp3_window_sse2,
+    musyx_envmix_sse2,
+    musyx_envmix_wide_sse2,
+    musyx_sfx_taps_sse2,
+    musyx_fir4_sse2
+};
+
+#endif
@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_tap.c                                     *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio_tap.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+
+/* the ring indices are shared between the emulation and consumer threads,
+ * MSVC builds only target x86 where a compiler barrier is enough */
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static uint32_t load_acquire(const uint32_t* x)
+{
+    uint32_t value = *(const volatile uint32_t*)x;
+    _ReadWriteBarrier();
+    return value;
+}
+
+static void store_release(uint32_t* x, uint32_t value)
+{
+    _ReadWriteBarrier();
+    *(volatile uint32_t*)x = value;
+}
+#else
+static uint32_t load_acquire(const uint32_t* x)
+{
+    return __atomic_load_n(x, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t* x, uint32_t value)
+{
+    __atomic_store_n(x, value, __ATOMIC_RELEASE);
+}
+#endif
+
+
+/* global functions */
+void audio_tap_emit(struct hle_t* hle, uint32_t address, uint32_t size)
+{
+    struct audio_tap_t* tap = &hle->audio_tap;
+    struct rsp_hle_audio_block block;
+
+    /* replays of the reference implementation must stay invisible */
+    if (hle->reference || size == 0)
+        return;
+
+    /* memoized tasks must emit their blocks when replayed */
+    if (hle->memo.recording)
+        memo_tap(hle, address, size);
+
+    if (!audio_tap_enabled(tap))
+        return;
+
+    block.data = hle->dram + address;
+    block.address = address;
+    block.size = size;
+
+    if (tap->callback != NULL)
+        tap->callback(tap->context, &block);
+
+    if (tap->ring_enabled) {
+        uint32_t head = tap->head;
+
+        if (head - load_acquire(&tap->tail) >= AUDIO_TAP_RING_SIZE) {
+            ++tap->dropped;
+            return;
+        }
+
+        tap->ring[head % AUDIO_TAP_RING_SIZE] = block;
+        store_release(&tap->head, head + 1);
+    }
+}
+
+void audio_tap_interleave(struct hle_t* hle, uint16_t dmem, uint16_t size)
+{
+    struct audio_tap_t* tap = &hle->audio_tap;
+
+    tap->has_output = true;
+    tap->output = dmem;
+    tap->output_size = size;
+}
+
+void audio_tap_save(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t size)
+{
+    const struct audio_tap_t* tap = &hle->audio_tap;
+
+    if (tap->has_output
+     && dmem < tap->output + tap->output_size
+     && tap->output < dmem + size)
+        audio_tap_emit(hle, address, size);
+}
+
+int audio_tap_pop(struct audio_tap_t* tap, struct rsp_hle_audio_block* block)
+{
+    uint32_t tail = tap->tail;
+
+    if (load_acquire(&tap->head) == tail)
+        return 0;
+
+    *block = tap->ring[tail % AUDIO_TAP_RING_SIZE];
+    store_release(&tap->tail, tail + 1);
+    return 1;
+}
+
+void audio_tap_release(struct hle_t* hle)
+{
+    struct audio_tap_t* tap = &hle->audio_tap;
+
+    if (tap->dropped != 0) {
+        HleWarnMessage(hle->user_defined,
+                "Audio tap: %u blocks dropped, the consumer did not keep up",
+                tap->dropped);
+    }
+
+    tap->dropped = 0;
+    tap->has_output = false;
+}
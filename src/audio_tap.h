@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - audio_tap.h                                     *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef AUDIO_TAP_H
+#define AUDIO_TAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rsp_hle_audio_tap.h"
+
+struct hle_t;
+
+enum { AUDIO_TAP_RING_SIZE = 64 };
+
+struct audio_tap_t
+{
+    rsp_hle_audio_tap_t callback;
+    void* context;
+
+    /* blocks for the consumer thread: head is only written by the
+     * emulation thread, tail only by the consumer thread */
+    int ring_enabled;
+    struct rsp_hle_audio_block ring[AUDIO_TAP_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    unsigned int dropped;
+
+    /* DMEM range of the last INTERLEAVE of the running audio list */
+    bool has_output;
+    uint16_t output;
+    uint16_t output_size;
+};
+
+static inline bool audio_tap_enabled(const struct audio_tap_t* tap)
+{
+    return tap->callback != NULL || tap->ring_enabled;
+}
+
+void audio_tap_emit(struct hle_t* hle, uint32_t address, uint32_t size);
+
+/* audio lists produce their output with INTERLEAVE, then save it */
+void audio_tap_interleave(struct hle_t* hle, uint16_t dmem, uint16_t size);
+void audio_tap_save(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t size);
+
+int audio_tap_pop(struct audio_tap_t* tap, struct rsp_hle_audio_block* block);
+void audio_tap_release(struct hle_t* hle);
+
+#endif
@@ -23,15 +23,20 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef ENABLE_TASK_DUMP
 #include <stdio.h>
 #endif
 
+#include "audio_kernels.h"
+#include "hle.h"
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
 #include "ucodes.h"
+#include "worker_pool.h"
 
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 
@@ -48,6 +53,9 @@ static ucode_func_t try_audio_task_detection(struct hle_t* hle);
 static ucode_func_t try_normal_task_detection(struct hle_t* hle);
 static ucode_func_t non_task_detection(struct hle_t* hle);
 static ucode_func_t task_detection(struct hle_t* hle);
+static bool is_shadowable_task(struct hle_t* hle, ucode_func_t uc_pfunc);
+static bool is_memoizable_task(struct hle_t* hle, ucode_func_t uc_pfunc);
+static bool is_capturable_task(struct hle_t* hle, ucode_func_t uc_pfunc);
 
 #ifdef ENABLE_TASK_DUMP
 static void dump_binary(struct hle_t* hle, const char *const filename,
@@ -58,6 +66,20 @@ static void dump_unknown_non_task(struct hle_t* hle, unsigned int uc_start);
 #endif
 
 /* Global functions */
+struct hle_t* hle_create(void)
+{
+    return calloc(1, sizeof(struct hle_t));
+}
+
+void hle_destroy(struct hle_t* hle)
+{
+    if (hle == NULL)
+        return;
+
+    hle_release(hle);
+    free(hle);
+}
+
 void hle_init(struct hle_t* hle,
     unsigned char* dram,
     unsigned char* dmem,
@@ -104,6 +126,57 @@ void hle_init(struct hle_t* hle,
     hle->dpc_pipebusy = dpc_pipebusy;
     hle->dpc_tmem     = dpc_tmem;
     hle->user_defined = user_defined;
+    hle->kernels      = audio_kernels_select();
+
+    if (hle->dram_size == 0)
+        hle->dram_size = HLE_DEFAULT_DRAM_SIZE;
+}
+
+void hle_configure(struct hle_t* hle, const struct hle_options_t* options)
+{
+    size_t dram_size;
+
+    hle->hle_gfx = options->hle_gfx;
+    hle->hle_aud = options->hle_aud;
+    hle->audio_accuracy = options->audio_accuracy;
+    hle->shadow.rate = options->shadow_rate;
+    hle->adpcm_cache.budget = options->adpcm_cache_size;
+    hle->memo.enabled = options->memoization;
+
+    /* buffers holding a copy of DRAM get allocated again on next use */
+    dram_size = (options->dram_size != 0) ? options->dram_size : HLE_DEFAULT_DRAM_SIZE;
+    if (hle->dram_size != dram_size) {
+        shadow_release(hle);
+        task_capture_release(hle);
+        hle->dram_size = dram_size;
+    }
+
+    /* the worker pool gets started again on next use */
+    if (hle->musyx_threads != options->musyx_threads) {
+        worker_pool_destroy(hle->workers);
+        hle->workers = NULL;
+    }
+    hle->musyx_threads = options->musyx_threads;
+
+    /* captures get closed along with the rom, so this opens one per session */
+    if (options->capture_filename != NULL && strlen(options->capture_filename) != 0
+     && hle->capture.file == NULL)
+        task_capture_open(hle, options->capture_filename);
+
+    HleInfoMessage(hle->user_defined, "Audio accuracy: %s",
+            hle_audio_accuracy_name(hle->audio_accuracy));
+
+    /* the fast tier is meant to diverge from the reference code paths */
+    if (hle->audio_accuracy == HLE_AUDIO_FAST && hle->shadow.rate != 0) {
+        HleWarnMessage(hle->user_defined,
+                "Shadow validation is disabled by the fast audio accuracy tier");
+        hle->shadow.rate = 0;
+    }
+}
+
+const char* hle_audio_accuracy_name(int audio_accuracy)
+{
+    return (audio_accuracy == HLE_AUDIO_FAST) ? "fast" : "bit-exact";
 }
 
 void hle_execute(struct hle_t* hle)
@@ -146,7 +219,43 @@ void hle_execute(struct hle_t* hle)
         assert(info->uc_pfunc != NULL);
     }
 
-    info->uc_pfunc(hle);
+    if (hle->capture.file != NULL && is_capturable_task(hle, info->uc_pfunc))
+        task_capture_task(hle);
+
+    if (hle->shadow.rate != 0 && is_shadowable_task(hle, info->uc_pfunc) && shadow_sample(hle))
+        shadow_execute(hle, info->uc_pfunc);
+    else if (hle->memo.enabled && is_memoizable_task(hle, info->uc_pfunc))
+        memo_execute(hle, info->uc_pfunc);
+    else
+        info->uc_pfunc(hle);
+}
+
+void hle_release(struct hle_t* hle)
+{
+    shadow_release(hle);
+    adpcm_cache_release(hle);
+    memo_release(hle);
+    audio_tap_release(hle);
+    task_capture_release(hle);
+
+    worker_pool_destroy(hle->workers);
+    hle->workers = NULL;
+}
+
+void hle_set_audio_tap(struct hle_t* hle, rsp_hle_audio_tap_t callback, void* context)
+{
+    hle->audio_tap.callback = callback;
+    hle->audio_tap.context = context;
+}
+
+void hle_enable_audio_tap_ring(struct hle_t* hle, int enable)
+{
+    hle->audio_tap.ring_enabled = enable;
+}
+
+int hle_pop_audio_tap_block(struct hle_t* hle, struct rsp_hle_audio_block* block)
+{
+    return audio_tap_pop(&hle->audio_tap, block);
 }
 
 /* local functions */
@@ -178,6 +287,11 @@ static bool is_task(struct hle_t* hle)
 
 void rsp_break(struct hle_t* hle, unsigned int setbits)
 {
+    if (hle->memo.recording) {
+        hle->memo.broke = 1;
+        hle->memo.break_bits |= setbits;
+    }
+
     *hle->sp_status |= setbits | SP_STATUS_BROKE | SP_STATUS_HALT;
 
     if ((*hle->sp_status & SP_STATUS_INTR_ON_BREAK)) {
@@ -432,6 +546,41 @@ static ucode_func_t task_detection(struct hle_t* hle)
     }
 }
 
+/**
+ * Only audio tasks that are entirely emulated here can be replayed for
+ * shadow validation: tasks handed over to other plugins or to the RSP
+ * fallback have side effects we can't undo.
+ **/
+static bool is_shadowable_task(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    return is_task(hle)
+        && *dmem_u32(hle, TASK_TYPE) == 2
+        && uc_pfunc != &send_alist_to_audio_plugin
+        && uc_pfunc != &alist_process_nead_mats
+        && uc_pfunc != &alist_process_nead_efz
+        && uc_pfunc != &unknown_task;
+}
+
+/**
+ * Memoization traces the DRAM accesses of the audio list commands only:
+ * MusyX and MP3 tasks are always run.
+ **/
+static bool is_memoizable_task(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    return is_shadowable_task(hle, uc_pfunc)
+        && uc_pfunc != &musyx_v1_task
+        && uc_pfunc != &musyx_v2_task
+        && uc_pfunc != &alist_process_naudio_mp3;
+}
+
+/**
+ * Captures hold the audio tasks rendered by the core itself.
+ **/
+static bool is_capturable_task(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    return is_shadowable_task(hle, uc_pfunc);
+}
+
 #ifdef ENABLE_TASK_DUMP
 static void dump_unknown_task(struct hle_t* hle, unsigned int uc_start)
 {
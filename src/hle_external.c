@@ -0,0 +1,135 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - hle_external.c                                  *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdarg.h>
+#include <string.h>
+
+#include "hle_external.h"
+#include "rsp_hle_core.h"
+
+/* callbacks registered by the user of the hle core */
+static struct hle_callbacks_t l_callbacks;
+
+
+/* Global functions */
+void hle_set_callbacks(const struct hle_callbacks_t* callbacks)
+{
+    if (callbacks != NULL)
+        l_callbacks = *callbacks;
+    else
+        memset(&l_callbacks, 0, sizeof(l_callbacks));
+}
+
+void HleVerboseMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    if (l_callbacks.verbose_message == NULL)
+        return;
+
+    va_start(args, message);
+    l_callbacks.verbose_message(user_defined, message, args);
+    va_end(args);
+}
+
+void HleInfoMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    if (l_callbacks.info_message == NULL)
+        return;
+
+    va_start(args, message);
+    l_callbacks.info_message(user_defined, message, args);
+    va_end(args);
+}
+
+void HleErrorMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    if (l_callbacks.error_message == NULL)
+        return;
+
+    va_start(args, message);
+    l_callbacks.error_message(user_defined, message, args);
+    va_end(args);
+}
+
+void HleWarnMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    if (l_callbacks.warn_message == NULL)
+        return;
+
+    va_start(args, message);
+    l_callbacks.warn_message(user_defined, message, args);
+    va_end(args);
+}
+
+void HleCheckInterrupts(void* user_defined)
+{
+    if (l_callbacks.check_interrupts == NULL)
+        return;
+
+    l_callbacks.check_interrupts(user_defined);
+}
+
+void HleProcessDlistList(void* user_defined)
+{
+    if (l_callbacks.process_dlist_list == NULL)
+        return;
+
+    l_callbacks.process_dlist_list(user_defined);
+}
+
+void HleProcessAlistList(void* user_defined)
+{
+    if (l_callbacks.process_alist_list == NULL)
+        return;
+
+    l_callbacks.process_alist_list(user_defined);
+}
+
+void HleProcessRdpList(void* user_defined)
+{
+    if (l_callbacks.process_rdp_list == NULL)
+        return;
+
+    l_callbacks.process_rdp_list(user_defined);
+}
+
+void HleShowCFB(void* user_defined)
+{
+    if (l_callbacks.show_cfb == NULL)
+        return;
+
+    l_callbacks.show_cfb(user_defined);
+}
+
+int HleForwardTask(void* user_defined)
+{
+    if (l_callbacks.forward_task == NULL)
+        return -1;
+
+    return l_callbacks.forward_task(user_defined);
+}
@@ -28,7 +28,8 @@
 #define ATTR_FMT(fmtpos, attrpos)
 #endif
 
-/* users of the hle core are expected to define these functions */
+/* hooks into the user of the hle core, forwarding to the callbacks
+ * registered with hle_set_callbacks (see hle_external.c) */
 
 void HleVerboseMessage(void* user_defined, const char *message, ...) ATTR_FMT(2, 3);
 void HleInfoMessage(void* user_defined, const char *message, ...) ATTR_FMT(2, 3);
@@ -24,8 +24,17 @@
 
 #include <stdint.h>
 
+#include "adpcm_cache.h"
+#include "audio_tap.h"
+#include "memo.h"
+#include "rsp_hle_core.h"
+#include "shadow.h"
+#include "task_capture.h"
 #include "ucodes.h"
 
+struct audio_kernels_t;
+struct worker_pool_t;
+
 /* rsp hle internal state - internal usage only */
 struct hle_t
 {
@@ -33,6 +42,9 @@ struct hle_t
     unsigned char* dmem;
     unsigned char* imem;
 
+    /* size of the dram buffer, in bytes */
+    size_t dram_size;
+
     unsigned int* mi_intr;
 
     unsigned int* sp_mem_addr;
@@ -60,6 +72,30 @@ struct hle_t
     int hle_gfx;
     int hle_aud;
 
+    /* HLE_AUDIO_BIT_EXACT or HLE_AUDIO_FAST */
+    int audio_accuracy;
+
+    /* when set, tasks must run through the scalar reference code paths */
+    int reference;
+
+    /* audio_kernels.c */
+    const struct audio_kernels_t* kernels;
+
+    /* shadow.c */
+    struct shadow_t shadow;
+
+    /* adpcm_cache.c */
+    struct adpcm_cache_t adpcm_cache;
+
+    /* memo.c */
+    struct memo_t memo;
+
+    /* audio_tap.c */
+    struct audio_tap_t audio_tap;
+
+    /* task_capture.c */
+    struct task_capture_t capture;
+
     /* alist.c */
     uint8_t alist_buffer[0x1000];
 
@@ -75,6 +111,11 @@ struct hle_t
     /* mp3.c */
     uint8_t  mp3_buffer[0x1000];
 
+    /* musyx.c */
+    struct musyx_codebooks_t musyx_codebooks;
+    unsigned int musyx_threads;
+    struct worker_pool_t* workers;
+
     struct cached_ucodes_t cached_ucodes;
 };
 
@@ -89,5 +130,11 @@ struct hle_t
 
 void rsp_break(struct hle_t* hle, unsigned int setbits);
 
+/* true if the current task may trade bit exactness for speed */
+static inline int hle_fast_audio(const struct hle_t* hle)
+{
+    return hle->audio_accuracy == HLE_AUDIO_FAST && !hle->reference;
+}
+
 #endif
 
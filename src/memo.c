@@ -0,0 +1,410 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - memo.c                                          *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "memory.h"
+#include "memo.h"
+
+/* tasks reading more than this are not worth recording */
+#define MEMO_MAX_READ_SIZE 0x100000
+#define MEMO_MAX_RANGES    0x4000
+
+/* everything an audio list can read or modify besides DRAM */
+struct memo_state_t {
+    uint8_t task[0x40];
+    uint8_t alist_buffer[0x1000];
+    struct alist_audio_t alist_audio;
+    struct alist_naudio_t alist_naudio;
+    struct alist_nead_t alist_nead;
+};
+
+struct memo_entry_t {
+    ucode_func_t uc_pfunc;
+    struct memo_state_t input;
+    struct memo_state_t output;
+
+    int broke;
+    unsigned int break_bits;
+
+    struct memo_range_t taps[MEMO_MAX_TAPS];
+    size_t tap_count;
+
+    struct memo_range_t* reads;
+    size_t read_count;
+    uint8_t* read_data;
+
+    struct memo_range_t* writes;
+    size_t write_count;
+    uint8_t* write_data;
+};
+
+
+/* local functions */
+static void save_state(struct memo_state_t* state, struct hle_t* hle)
+{
+    memcpy(state->task, hle->dmem + TASK_TYPE, sizeof(state->task));
+    memcpy(state->alist_buffer, hle->alist_buffer, sizeof(state->alist_buffer));
+    memcpy(&state->alist_audio, &hle->alist_audio, sizeof(state->alist_audio));
+    memcpy(&state->alist_naudio, &hle->alist_naudio, sizeof(state->alist_naudio));
+    memcpy(&state->alist_nead, &hle->alist_nead, sizeof(state->alist_nead));
+}
+
+static void restore_state(struct hle_t* hle, const struct memo_state_t* state)
+{
+    memcpy(hle->alist_buffer, state->alist_buffer, sizeof(state->alist_buffer));
+    memcpy(&hle->alist_audio, &state->alist_audio, sizeof(state->alist_audio));
+    memcpy(&hle->alist_naudio, &state->alist_naudio, sizeof(state->alist_naudio));
+    memcpy(&hle->alist_nead, &state->alist_nead, sizeof(state->alist_nead));
+}
+
+static bool same_state(struct hle_t* hle, const struct memo_state_t* state)
+{
+    return memcmp(state->task, hle->dmem + TASK_TYPE, sizeof(state->task)) == 0
+        && memcmp(state->alist_buffer, hle->alist_buffer, sizeof(state->alist_buffer)) == 0
+        && memcmp(&state->alist_audio, &hle->alist_audio, sizeof(state->alist_audio)) == 0
+        && memcmp(&state->alist_naudio, &hle->alist_naudio, sizeof(state->alist_naudio)) == 0
+        && memcmp(&state->alist_nead, &hle->alist_nead, sizeof(state->alist_nead)) == 0;
+}
+
+static void free_entry(struct memo_entry_t* entry)
+{
+    if (entry == NULL)
+        return;
+
+    free(entry->reads);
+    free(entry->read_data);
+    free(entry->writes);
+    free(entry->write_data);
+    free(entry);
+}
+
+static bool grow(void** buffer, size_t* capacity, size_t needed, size_t element_size)
+{
+    size_t new_capacity = (*capacity != 0) ? *capacity : 64;
+    void* new_buffer;
+
+    if (needed <= *capacity)
+        return true;
+
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    new_buffer = realloc(*buffer, new_capacity * element_size);
+    if (new_buffer == NULL)
+        return false;
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return true;
+}
+
+/* append a range to log, merging it with the last one when contiguous */
+static bool log_range(struct memo_log_t* log, uint32_t address, uint32_t size)
+{
+    struct memo_range_t* last = (log->count != 0) ? &log->ranges[log->count - 1] : NULL;
+
+    if (last != NULL && last->address + last->size == address) {
+        last->size += size;
+        return true;
+    }
+
+    if (log->count >= MEMO_MAX_RANGES
+     || !grow((void**)&log->ranges, &log->capacity, log->count + 1, sizeof(log->ranges[0])))
+        return false;
+
+    log->ranges[log->count].address = address;
+    log->ranges[log->count].size = size;
+    ++log->count;
+    return true;
+}
+
+static bool reads_match(struct hle_t* hle, const struct memo_entry_t* entry)
+{
+    const uint8_t* data = entry->read_data;
+    size_t i;
+
+    for (i = 0; i < entry->read_count; ++i) {
+        const struct memo_range_t* range = &entry->reads[i];
+
+        if (memcmp(hle->dram + range->address, data, range->size) != 0)
+            return false;
+
+        data += range->size;
+    }
+
+    return true;
+}
+
+static struct memo_entry_t* find_entry(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    struct memo_t* memo = &hle->memo;
+    unsigned int i;
+
+    for (i = 0; i < MEMO_ENTRIES; ++i) {
+        struct memo_entry_t* entry = memo->entries[i];
+
+        if (entry != NULL
+         && entry->uc_pfunc == uc_pfunc
+         && same_state(hle, &entry->input)
+         && reads_match(hle, entry))
+            return entry;
+    }
+
+    return NULL;
+}
+
+static void replay(struct hle_t* hle, const struct memo_entry_t* entry)
+{
+    const uint8_t* data = entry->write_data;
+    size_t i;
+
+    for (i = 0; i < entry->write_count; ++i) {
+        const struct memo_range_t* range = &entry->writes[i];
+
+        memcpy(hle->dram + range->address, data, range->size);
+        data += range->size;
+    }
+
+    restore_state(hle, &entry->output);
+
+    for (i = 0; i < entry->tap_count; ++i)
+        audio_tap_emit(hle, entry->taps[i].address, entry->taps[i].size);
+
+    if (entry->broke)
+        rsp_break(hle, entry->break_bits);
+}
+
+/* move the logs of the task which just ran into entry, along with the
+ * final contents of the written ranges */
+static bool complete_entry(struct hle_t* hle, struct memo_entry_t* entry)
+{
+    struct memo_t* memo = &hle->memo;
+    size_t write_size = 0;
+    uint8_t* data;
+    size_t i;
+
+    for (i = 0; i < memo->writes.count; ++i)
+        write_size += memo->writes.ranges[i].size;
+
+    entry->reads = malloc(memo->reads.count * sizeof(entry->reads[0]) + 1);
+    entry->read_data = malloc(memo->reads.size + 1);
+    entry->writes = malloc(memo->writes.count * sizeof(entry->writes[0]) + 1);
+    entry->write_data = malloc(write_size + 1);
+
+    if (entry->reads == NULL || entry->read_data == NULL
+     || entry->writes == NULL || entry->write_data == NULL)
+        return false;
+
+    entry->read_count = memo->reads.count;
+    memcpy(entry->reads, memo->reads.ranges, memo->reads.count * sizeof(entry->reads[0]));
+    memcpy(entry->read_data, memo->reads.data, memo->reads.size);
+
+    entry->write_count = memo->writes.count;
+    memcpy(entry->writes, memo->writes.ranges, memo->writes.count * sizeof(entry->writes[0]));
+
+    data = entry->write_data;
+    for (i = 0; i < memo->writes.count; ++i) {
+        const struct memo_range_t* range = &memo->writes.ranges[i];
+
+        memcpy(data, hle->dram + range->address, range->size);
+        data += range->size;
+    }
+
+    entry->broke = memo->broke;
+    entry->break_bits = memo->break_bits;
+    entry->tap_count = memo->tap_count;
+    memcpy(entry->taps, memo->taps, memo->tap_count * sizeof(entry->taps[0]));
+    save_state(&entry->output, hle);
+
+    return true;
+}
+
+
+/* global functions */
+void memo_read(struct hle_t* hle, uint32_t address, size_t size)
+{
+    struct memo_t* memo = &hle->memo;
+    struct memo_log_t* reads = &memo->reads;
+    uint32_t begin = address & ~3;
+    uint32_t end = (uint32_t)align(address + size, 4);
+
+    if (size == 0)
+        return;
+
+    /* swizzling permutes bytes within words, so whole words get compared */
+    size = end - begin;
+
+    /* entries only hold ranges within the dram buffer */
+    if (end > hle->dram_size) {
+        memo_poison(hle);
+        return;
+    }
+
+    if (reads->size + size > MEMO_MAX_READ_SIZE
+     || !grow((void**)&reads->data, &reads->data_capacity, reads->size + size, 1)
+     || !log_range(reads, begin, size)) {
+        memo_poison(hle);
+        return;
+    }
+
+    memcpy(reads->data + reads->size, hle->dram + begin, size);
+    reads->size += size;
+}
+
+void memo_write(struct hle_t* hle, uint32_t address, size_t size, size_t element_size)
+{
+    /* writes must be exact: swizzled elements of partial words are
+     * logged one by one, at the place they really went to */
+    const uint32_t swizzle = (element_size == 1) ? S8
+                           : (element_size == 2) ? S16
+                           : 0;
+    bool ok = true;
+
+    /* entries only hold ranges within the dram buffer */
+    if (address + size > hle->dram_size) {
+        memo_poison(hle);
+        return;
+    }
+
+    while (size != 0 && (address & 3) != 0) {
+        ok &= log_range(&hle->memo.writes, address ^ swizzle, element_size);
+        address += element_size;
+        size -= element_size;
+    }
+
+    if (size >= 4) {
+        ok &= log_range(&hle->memo.writes, address, size & ~3);
+        address += size & ~3;
+        size &= 3;
+    }
+
+    while (size != 0) {
+        ok &= log_range(&hle->memo.writes, address ^ swizzle, element_size);
+        address += element_size;
+        size -= element_size;
+    }
+
+    if (!ok)
+        memo_poison(hle);
+}
+
+void memo_tap(struct hle_t* hle, uint32_t address, size_t size)
+{
+    struct memo_t* memo = &hle->memo;
+
+    if (memo->tap_count >= MEMO_MAX_TAPS) {
+        memo_poison(hle);
+        return;
+    }
+
+    memo->taps[memo->tap_count].address = address;
+    memo->taps[memo->tap_count].size = (uint32_t)size;
+    ++memo->tap_count;
+}
+
+void memo_poison(struct hle_t* hle)
+{
+    hle->memo.poisoned = 1;
+    hle->memo.recording = 0;
+}
+
+void memo_execute(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    struct memo_t* memo = &hle->memo;
+    struct memo_entry_t* entry = find_entry(hle, uc_pfunc);
+
+    if (entry != NULL) {
+        replay(hle, entry);
+        ++memo->hits;
+        return;
+    }
+
+    ++memo->misses;
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        HleErrorMessage(hle->user_defined,
+                "Can't allocate audio task memoization entry, disabling memoization.");
+        memo_release(hle);
+        memo->enabled = 0;
+        uc_pfunc(hle);
+        return;
+    }
+
+    entry->uc_pfunc = uc_pfunc;
+    save_state(&entry->input, hle);
+
+    memo->reads.count = 0;
+    memo->reads.size = 0;
+    memo->writes.count = 0;
+    memo->tap_count = 0;
+    memo->broke = 0;
+    memo->break_bits = 0;
+    memo->poisoned = 0;
+    memo->recording = 1;
+
+    uc_pfunc(hle);
+
+    memo->recording = 0;
+
+    if (memo->poisoned || !complete_entry(hle, entry)) {
+        free_entry(entry);
+        ++memo->unmemoizable;
+        return;
+    }
+
+    free_entry(memo->entries[memo->next]);
+    memo->entries[memo->next] = entry;
+    memo->next = (memo->next + 1) % MEMO_ENTRIES;
+}
+
+void memo_release(struct hle_t* hle)
+{
+    struct memo_t* memo = &hle->memo;
+    unsigned int i;
+
+    if (memo->hits + memo->misses != 0) {
+        HleInfoMessage(hle->user_defined,
+                "Audio task memoization: %u hits, %u misses, %u tasks not memoizable",
+                memo->hits, memo->misses, memo->unmemoizable);
+    }
+
+    for (i = 0; i < MEMO_ENTRIES; ++i) {
+        free_entry(memo->entries[i]);
+        memo->entries[i] = NULL;
+    }
+
+    free(memo->reads.ranges);
+    free(memo->reads.data);
+    free(memo->writes.ranges);
+    memset(&memo->reads, 0, sizeof(memo->reads));
+    memset(&memo->writes, 0, sizeof(memo->writes));
+
+    memo->next = 0;
+    memo->hits = 0;
+    memo->misses = 0;
+    memo->unmemoizable = 0;
+}
@@ -0,0 +1,91 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - memo.h                                          *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ucodes.h"
+
+enum { MEMO_ENTRIES = 4 };
+enum { MEMO_MAX_TAPS = 4 };
+
+struct memo_entry_t;
+
+struct memo_range_t {
+    uint32_t address;
+    uint32_t size;
+};
+
+struct memo_log_t {
+    struct memo_range_t* ranges;
+    size_t count;
+    size_t capacity;
+
+    /* contents of the ranges, for reads only */
+    uint8_t* data;
+    size_t size;
+    size_t data_capacity;
+};
+
+/* Audio task memoization: while an audio list runs, every DRAM range it
+ * reads (with its contents) and writes gets recorded. A later task with
+ * the same task header and audio ucode state, which finds the same bytes
+ * in all these ranges, would then behave exactly the same, so the recorded
+ * writes and resulting state are replayed instead of running it. */
+struct memo_t {
+    int enabled;
+
+    /* recording state of the running task */
+    int recording;
+    int poisoned;
+    int broke;
+    unsigned int break_bits;
+    struct memo_log_t reads;
+    struct memo_log_t writes;
+    struct memo_range_t taps[MEMO_MAX_TAPS];
+    size_t tap_count;
+
+    /* most recently recorded tasks */
+    struct memo_entry_t* entries[MEMO_ENTRIES];
+    unsigned int next;
+
+    /* statistics */
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int unmemoizable;
+};
+
+void memo_read(struct hle_t* hle, uint32_t address, size_t size);
+void memo_write(struct hle_t* hle, uint32_t address, size_t size, size_t element_size);
+
+/* the running task emits an audio tap block */
+void memo_tap(struct hle_t* hle, uint32_t address, size_t size);
+
+/* the running task does something which cannot be replayed */
+void memo_poison(struct hle_t* hle);
+
+void memo_execute(struct hle_t* hle, ucode_func_t uc_pfunc);
+void memo_release(struct hle_t* hle);
+
+#endif
@@ -135,6 +135,21 @@ static inline void dmem_store_u32(struct hle_t* hle, const uint32_t* src, uint16
     store_u32(hle->dmem, address & 0xfff, src, count);
 }
 
+/* DRAM ranges accessed by a memoized task must be traced (see memo.c),
+ * which the load/store helpers below do. Accesses through pointers must be
+ * traced by their callers */
+static inline void dram_trace_read(struct hle_t* hle, uint32_t address, size_t size)
+{
+    if (hle->memo.recording)
+        memo_read(hle, address, size);
+}
+
+static inline void dram_trace_write(struct hle_t* hle, uint32_t address, size_t size, size_t element_size)
+{
+    if (hle->memo.recording)
+        memo_write(hle, address, size, element_size);
+}
+
 /* convenient functions DRAM access */
 static inline uint8_t* dram_u8(struct hle_t* hle, uint32_t address)
 {
@@ -153,31 +168,37 @@ static inline uint32_t* dram_u32(struct hle_t* hle, uint32_t address)
 
 static inline void dram_load_u8(struct hle_t* hle, uint8_t* dst, uint32_t address, size_t count)
 {
+    dram_trace_read(hle, address & 0xffffff, count * 1);
     load_u8(dst, hle->dram, address & 0xffffff, count);
 }
 
 static inline void dram_load_u16(struct hle_t* hle, uint16_t* dst, uint32_t address, size_t count)
 {
+    dram_trace_read(hle, address & 0xffffff, count * 2);
     load_u16(dst, hle->dram, address & 0xffffff, count);
 }
 
 static inline void dram_load_u32(struct hle_t* hle, uint32_t* dst, uint32_t address, size_t count)
 {
+    dram_trace_read(hle, address & 0xffffff, count * 4);
     load_u32(dst, hle->dram, address & 0xffffff, count);
 }
 
 static inline void dram_store_u8(struct hle_t* hle, const uint8_t* src, uint32_t address, size_t count)
 {
+    dram_trace_write(hle, address & 0xffffff, count * 1, 1);
     store_u8(hle->dram, address & 0xffffff, src, count);
 }
 
 static inline void dram_store_u16(struct hle_t* hle, const uint16_t* src, uint32_t address, size_t count)
 {
+    dram_trace_write(hle, address & 0xffffff, count * 2, 2);
     store_u16(hle->dram, address & 0xffffff, src, count);
 }
 
 static inline void dram_store_u32(struct hle_t* hle, const uint32_t* src, uint32_t address, size_t count)
 {
+    dram_trace_write(hle, address & 0xffffff, count * 4, 4);
     store_u32(hle->dram, address & 0xffffff, src, count);
 }
 
@@ -25,13 +25,22 @@
 #include <string.h>
 
 #include "arithmetics.h"
+#include "audio_kernels.h"
 #include "hle_internal.h"
 #include "memory.h"
 
 static void InnerLoop(struct hle_t* hle,
-                      uint32_t outPtr, uint32_t inPtr,
+                      uint8_t* out, const uint8_t* in,
                       uint32_t t6, uint32_t t5, uint32_t t4);
 
+/* staging areas of mp3_buffer */
+enum {
+    MP3_HEADER = 0xCE8,
+    MP3_INPUT  = 0xCF0,
+    MP3_OUTPUT = 0xE70,
+    MP3_CHUNK_SIZE = 0x180
+};
+
 static const uint16_t DeWindowLUT [0x420] = {
     0x0000, 0xFFF3, 0x005D, 0xFF38, 0x037A, 0xF736, 0x0B37, 0xC00E,
     0x7FFF, 0x3FF2, 0x0B37, 0x08CA, 0x037A, 0x00C8, 0x005D, 0x000D,
@@ -167,45 +176,10 @@ static const uint16_t DeWindowLUT [0x420] = {
     0x0B37, 0xF736, 0x037A, 0xFF38, 0x005D, 0xFFF3, 0x0000, 0x0000
 };
 
-static void MP3AB0(int32_t* v)
-{
-    /* Part 2 - 100% Accurate */
-    static const uint16_t LUT2[8] = {
-        0xFEC4, 0xF4FA, 0xC5E4, 0xE1C4,
-        0x1916, 0x4A50, 0xA268, 0x78AE
-    };
-    static const uint16_t LUT3[4] = { 0xFB14, 0xD4DC, 0x31F2, 0x8E3A };
-    int i;
-
-    for (i = 0; i < 8; i++) {
-        v[16 + i] = v[0 + i] + v[8 + i];
-        v[24 + i] = ((v[0 + i] - v[8 + i]) * LUT2[i]) >> 0x10;
-    }
-
-    /* Part 3: 4-wide butterflies */
-
-    for (i = 0; i < 4; i++) {
-        v[0 + i]  = v[16 + i] + v[20 + i];
-        v[4 + i]  = ((v[16 + i] - v[20 + i]) * LUT3[i]) >> 0x10;
-
-        v[8 + i]  = v[24 + i] + v[28 + i];
-        v[12 + i] = ((v[24 + i] - v[28 + i]) * LUT3[i]) >> 0x10;
-    }
-
-    /* Part 4: 2-wide butterflies - 100% Accurate */
-
-    for (i = 0; i < 16; i += 4) {
-        v[16 + i] = v[0 + i] + v[2 + i];
-        v[18 + i] = ((v[0 + i] - v[2 + i]) * 0xEC84) >> 0x10;
-
-        v[17 + i] = v[1 + i] + v[3 + i];
-        v[19 + i] = ((v[1 + i] - v[3 + i]) * 0x61F8) >> 0x10;
-    }
-}
-
 void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address)
 {
-    uint32_t inPtr, outPtr;
+    const uint8_t* inPtr;
+    uint8_t* outPtr;
     uint32_t t6;/* = 0x08A0; - I think these are temporary storage buffers */
     uint32_t t5;/* = 0x0AC0; */
     uint32_t t4;/* = (w1 & 0x1E); */
@@ -215,25 +189,38 @@ void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address)
     uint32_t writePtr; /* s6 */
     uint32_t tmp;
     int cnt, cnt2;
+    int direct;
 
     /* I think these are temporary storage buffers */
     t6 = 0x08A0;
     t5 = 0x0AC0;
     t4 = index;
 
+    /* RDRAM words are laid out as DMEM ones, so frames can be decoded in
+     * place instead of going through the staging buffer, as long as their
+     * samples are aligned. Each InnerLoop reads all its input before
+     * writing its output, which is what makes the overlap between the
+     * output chunk and the input one 8 bytes further safe */
+    direct = (address & 1) == 0;
+
     writePtr = readPtr = address;
     /* Just do that for efficiency... may remove and use directly later anyway */
-    memcpy(hle->mp3_buffer + 0xCE8, hle->dram + readPtr, 8);
+    memcpy(hle->mp3_buffer + MP3_HEADER, hle->dram + readPtr, 8);
     /* This must be a header byte or whatnot */
     readPtr += 8;
 
-    for (cnt = 0; cnt < 0x480; cnt += 0x180) {
-        /* DMA: 0xCF0 <- RDRAM[s5] : 0x180 */
-        memcpy(hle->mp3_buffer + 0xCF0, hle->dram + readPtr, 0x180);
-        inPtr  = 0xCF0; /* s7 */
-        outPtr = 0xE70; /* s3 */
+    for (cnt = 0; cnt < 0x480; cnt += MP3_CHUNK_SIZE) {
+        if (direct) {
+            inPtr  = hle->dram + readPtr;
+            outPtr = hle->dram + writePtr;
+        } else {
+            /* DMA: 0xCF0 <- RDRAM[s5] : 0x180 */
+            memcpy(hle->mp3_buffer + MP3_INPUT, hle->dram + readPtr, MP3_CHUNK_SIZE);
+            inPtr  = hle->mp3_buffer + MP3_INPUT; /* s7 */
+            outPtr = hle->mp3_buffer + MP3_OUTPUT; /* s3 */
+        }
 /* --------------- Inner Loop Start -------------------- */
-        for (cnt2 = 0; cnt2 < 0x180; cnt2 += 0x40) {
+        for (cnt2 = 0; cnt2 < MP3_CHUNK_SIZE; cnt2 += 0x40) {
             t6 &= 0xFFE0;
             t5 &= 0xFFE0;
             t6 |= t4;
@@ -247,18 +234,24 @@ void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address)
             outPtr += 0x40;
         }
 /* --------------- Inner Loop End -------------------- */
-        memcpy(hle->dram + writePtr, hle->mp3_buffer + 0xe70, 0x180);
-        writePtr += 0x180;
-        readPtr  += 0x180;
+        if (!direct)
+            memcpy(hle->dram + writePtr, hle->mp3_buffer + MP3_OUTPUT, MP3_CHUNK_SIZE);
+        writePtr += MP3_CHUNK_SIZE;
+        readPtr  += MP3_CHUNK_SIZE;
     }
 }
 
+/* in and out point to 32 samples laid out as in DMEM */
 static void InnerLoop(struct hle_t* hle,
-                      uint32_t outPtr, uint32_t inPtr,
+                      uint8_t* out, const uint8_t* in,
                       uint32_t t6, uint32_t t5, uint32_t t4)
 {
     /* Part 1: 100% Accurate */
 
+    /* input sample paired with its mirror (31 - n) by each butterfly */
+    static const uint8_t INPUT_ORDER[16] = {
+        0, 1, 3, 2, 7, 6, 4, 5, 15, 14, 12, 13, 8, 9, 11, 10
+    };
     /* 0, 1, 3, 2, 7, 6, 4, 5, 7, 6, 4, 5, 0, 1, 3, 2 */
     static const uint16_t LUT6[16] = {
         0xFFB2, 0xFD3A, 0xF10A, 0xF854,
@@ -266,78 +259,42 @@ static void InnerLoop(struct hle_t* hle,
         0x1920, 0x4B20, 0xAC7C, 0x7C68,
         0xABEC, 0x9880, 0xDAE8, 0x839C
     };
+    /* scaled values of part 6 which get doubled */
+    static const int32_t DOUBLED6[16] = {
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 0, 0, 0, -1, -1, 0, -1
+    };
+    const struct audio_kernels_t* kernels = audio_kernels(hle);
+    const int16_t* samples;
+    int32_t window[2][8];
     int i;
     uint32_t t0;
     uint32_t t1;
     uint32_t t2;
     uint32_t t3;
-    int32_t v2 = 0, v4 = 0, v6 = 0, v8 = 0;
+    int32_t v2 = 0, v4 = 0;
     uint32_t offset;
     uint32_t addptr;
     int x;
     int32_t mult6;
     int32_t mult4;
-    int tmp;
     int32_t hi0;
     int32_t hi1;
     int32_t vt;
+    int16_t input[32];
+    int16_t output[33];
     int32_t v[32];
 
-    v[0] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x00 ^ S16));
-    v[31] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3E ^ S16));
-    v[0] += v[31];
-    v[1] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x02 ^ S16));
-    v[30] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3C ^ S16));
-    v[1] += v[30];
-    v[2] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x06 ^ S16));
-    v[28] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x38 ^ S16));
-    v[2] += v[28];
-    v[3] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x04 ^ S16));
-    v[29] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3A ^ S16));
-    v[3] += v[29];
-
-    v[4] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0E ^ S16));
-    v[24] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x30 ^ S16));
-    v[4] += v[24];
-    v[5] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0C ^ S16));
-    v[25] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x32 ^ S16));
-    v[5] += v[25];
-    v[6] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x08 ^ S16));
-    v[27] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x36 ^ S16));
-    v[6] += v[27];
-    v[7] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0A ^ S16));
-    v[26] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x34 ^ S16));
-    v[7] += v[26];
-
-    v[8] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1E ^ S16));
-    v[16] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x20 ^ S16));
-    v[8] += v[16];
-    v[9] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1C ^ S16));
-    v[17] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x22 ^ S16));
-    v[9] += v[17];
-    v[10] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x18 ^ S16));
-    v[19] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x26 ^ S16));
-    v[10] += v[19];
-    v[11] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1A ^ S16));
-    v[18] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x24 ^ S16));
-    v[11] += v[18];
-
-    v[12] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x10 ^ S16));
-    v[23] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2E ^ S16));
-    v[12] += v[23];
-    v[13] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x12 ^ S16));
-    v[22] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2C ^ S16));
-    v[13] += v[22];
-    v[14] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x16 ^ S16));
-    v[20] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x28 ^ S16));
-    v[14] += v[20];
-    v[15] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x14 ^ S16));
-    v[21] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2A ^ S16));
-    v[15] += v[21];
+    /* the 32 input samples, read once in host order */
+    for (i = 0; i < 32; i++)
+        input[i] = *(const int16_t *)(in + ((2 * i) ^ S16));
+
+    for (i = 0; i < 16; i++)
+        v[i] = input[INPUT_ORDER[i]] + input[31 - INPUT_ORDER[i]];
 
     /* Part 2-4 */
 
-    MP3AB0(v);
+    kernels->mp3_butterflies(v);
 
     /* Part 5 - 1-Wide Butterflies - 100% Accurate but need SSVs!!! */
 
@@ -430,73 +387,12 @@ static void InnerLoop(struct hle_t* hle,
 
     /* Part 6 - 100% Accurate */
 
-    v[0] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x00 ^ S16));
-    v[31] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3E ^ S16));
-    v[0] -= v[31];
-    v[1] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x02 ^ S16));
-    v[30] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3C ^ S16));
-    v[1] -= v[30];
-    v[2] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x06 ^ S16));
-    v[28] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x38 ^ S16));
-    v[2] -= v[28];
-    v[3] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x04 ^ S16));
-    v[29] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x3A ^ S16));
-    v[3] -= v[29];
-
-    v[4] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0E ^ S16));
-    v[24] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x30 ^ S16));
-    v[4] -= v[24];
-    v[5] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0C ^ S16));
-    v[25] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x32 ^ S16));
-    v[5] -= v[25];
-    v[6] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x08 ^ S16));
-    v[27] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x36 ^ S16));
-    v[6] -= v[27];
-    v[7] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x0A ^ S16));
-    v[26] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x34 ^ S16));
-    v[7] -= v[26];
-
-    v[8] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1E ^ S16));
-    v[16] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x20 ^ S16));
-    v[8] -= v[16];
-    v[9] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1C ^ S16));
-    v[17] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x22 ^ S16));
-    v[9] -= v[17];
-    v[10] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x18 ^ S16));
-    v[19] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x26 ^ S16));
-    v[10] -= v[19];
-    v[11] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x1A ^ S16));
-    v[18] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x24 ^ S16));
-    v[11] -= v[18];
-
-    v[12] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x10 ^ S16));
-    v[23] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2E ^ S16));
-    v[12] -= v[23];
-    v[13] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x12 ^ S16));
-    v[22] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2C ^ S16));
-    v[13] -= v[22];
-    v[14] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x16 ^ S16));
-    v[20] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x28 ^ S16));
-    v[14] -= v[20];
-    v[15] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x14 ^ S16));
-    v[21] = *(int16_t *)(hle->mp3_buffer + inPtr + (0x2A ^ S16));
-    v[15] -= v[21];
-
     for (i = 0; i < 16; i++)
-        v[0 + i] = (v[0 + i] * LUT6[i]) >> 0x10;
-    v[0] = v[0] + v[0];
-    v[1] = v[1] + v[1];
-    v[2] = v[2] + v[2];
-    v[3] = v[3] + v[3];
-    v[4] = v[4] + v[4];
-    v[5] = v[5] + v[5];
-    v[6] = v[6] + v[6];
-    v[7] = v[7] + v[7];
-    v[12] = v[12] + v[12];
-    v[13] = v[13] + v[13];
-    v[15] = v[15] + v[15];
+        v[i] = input[INPUT_ORDER[i]] - input[31 - INPUT_ORDER[i]];
 
-    MP3AB0(v);
+    kernels->mp3_scale(v, LUT6, DOUBLED6, 16);
+
+    kernels->mp3_butterflies(v);
 
     /* Part 7: - 100% Accurate + SSV - Unoptimized */
 
@@ -575,31 +471,21 @@ static void InnerLoop(struct hle_t* hle,
 
     addptr = t6 & 0xFFE0;
 
+    /* v0 and v18 of each output pair are dot products of 16 taps */
     offset = 0x10 - (t4 >> 1);
+    samples = (const int16_t*)(hle->mp3_buffer + addptr);
+    kernels->mp3_window(window[0], samples, 0x20,
+                        (const int16_t*)DeWindowLUT + offset, 0x40, 8, 0);
+    kernels->mp3_window(window[1], samples + 0x10, 0x20,
+                        (const int16_t*)DeWindowLUT + offset + 0x20, 0x40, 8, 0);
     for (x = 0; x < 8; x++) {
-        int32_t v0;
-        int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
-
-        for (i = 7; i >= 0; i--) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            addptr += 2;
-            offset++;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
-        *(int16_t *)(hle->mp3_buffer + (outPtr ^ S16)) = v0;
-        *(int16_t *)(hle->mp3_buffer + ((outPtr + 2)^S16)) = v18;
-        outPtr += 4;
-        addptr += 0x30;
-        offset += 0x38;
+        output[2 * x + 0] = window[0][x];
+        output[2 * x + 1] = window[1][x];
     }
+    addptr += 8 * 0x40;
 
     offset = 0x10 - (t4 >> 1) + 8 * 0x40;
     v2 = v4 = 0;
@@ -613,49 +499,33 @@ static void InnerLoop(struct hle_t* hle,
         addptr += 2;
         offset++;
     }
-    mult6 = *(int32_t *)(hle->mp3_buffer + 0xCE8);
-    mult4 = *(int32_t *)(hle->mp3_buffer + 0xCEC);
+    mult6 = *(int32_t *)(hle->mp3_buffer + MP3_HEADER);
+    mult4 = *(int32_t *)(hle->mp3_buffer + MP3_HEADER + 4);
     if (t4 & 0x2) {
-        v2 = (v2 **(uint32_t *)(hle->mp3_buffer + 0xCE8)) >> 0x10;
-        *(int16_t *)(hle->mp3_buffer + (outPtr ^ S16)) = v2;
+        v2 = (v2 **(uint32_t *)(hle->mp3_buffer + MP3_HEADER)) >> 0x10;
+        output[16] = v2;
     } else {
-        v4 = (v4 **(uint32_t *)(hle->mp3_buffer + 0xCE8)) >> 0x10;
-        *(int16_t *)(hle->mp3_buffer + (outPtr ^ S16)) = v4;
-        mult4 = *(uint32_t *)(hle->mp3_buffer + 0xCE8);
+        v4 = (v4 **(uint32_t *)(hle->mp3_buffer + MP3_HEADER)) >> 0x10;
+        output[16] = v4;
+        mult4 = *(uint32_t *)(hle->mp3_buffer + MP3_HEADER);
     }
     addptr -= 0x50;
 
+    /* same with every odd tap subtracted, going backwards through samples */
+    offset = 0x22F - (t4 >> 1);
+    samples = (const int16_t*)(hle->mp3_buffer + addptr);
+    kernels->mp3_window(window[0], samples + 0x10, -0x20,
+                        (const int16_t*)DeWindowLUT + offset, 0x40, 8, 1);
+    kernels->mp3_window(window[1], samples, -0x20,
+                        (const int16_t*)DeWindowLUT + offset + 0x20, 0x40, 8, 1);
     for (x = 0; x < 8; x++) {
-        int32_t v0;
-        int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
-
-        offset = (0x22F - (t4 >> 1) + x * 0x40);
-
-        for (i = 0; i < 4; i++) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v2 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x20) * (short)DeWindowLUT[offset + 0x01] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v4 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x30) * (short)DeWindowLUT[offset + 0x09] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v6 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x00) * (short)DeWindowLUT[offset + 0x21] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            v8 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x10) * (short)DeWindowLUT[offset + 0x29] + 0x4000) >> 0xF;
-            addptr += 4;
-            offset += 2;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
-        *(int16_t *)(hle->mp3_buffer + ((outPtr + 2)^S16)) = v0;
-        *(int16_t *)(hle->mp3_buffer + ((outPtr + 4)^S16)) = v18;
-        outPtr += 4;
-        addptr -= 0x50;
+        output[2 * x + 17] = window[0][x];
+        output[2 * x + 18] = window[1][x];
     }
 
-    tmp = outPtr;
     hi0 = mult6;
     hi1 = mult4;
 
@@ -663,22 +533,28 @@ static void InnerLoop(struct hle_t* hle,
     hi1 = (int)hi1 >> 0x10;
     for (i = 0; i < 8; i++) {
         /* v0 */
-        vt = (*(int16_t *)(hle->mp3_buffer + ((tmp - 0x40)^S16)) * hi0);
-        *(int16_t *)((uint8_t *)hle->mp3_buffer + ((tmp - 0x40)^S16)) = clamp_s16(vt);
+        vt = output[i] * hi0;
+        output[i] = clamp_s16(vt);
 
         /* v17 */
-        vt = (*(int16_t *)(hle->mp3_buffer + ((tmp - 0x30)^S16)) * hi0);
-        *(int16_t *)((uint8_t *)hle->mp3_buffer + ((tmp - 0x30)^S16)) = clamp_s16(vt);
+        vt = output[i + 8] * hi0;
+        output[i + 8] = clamp_s16(vt);
 
         /* v2 */
-        vt = (*(int16_t *)(hle->mp3_buffer + ((tmp - 0x1E)^S16)) * hi1);
-        *(int16_t *)((uint8_t *)hle->mp3_buffer + ((tmp - 0x1E)^S16)) = clamp_s16(vt);
+        vt = output[i + 17] * hi1;
+        output[i + 17] = clamp_s16(vt);
 
         /* v4 */
-        vt = (*(int16_t *)(hle->mp3_buffer + ((tmp - 0xE)^S16)) * hi1);
-        *(int16_t *)((uint8_t *)hle->mp3_buffer + ((tmp - 0xE)^S16)) = clamp_s16(vt);
-
-        tmp += 2;
+        vt = output[i + 25] * hi1;
+        output[i + 25] = clamp_s16(vt);
     }
+
+    for (i = 0; i < 32; i++)
+        *(int16_t *)(out + ((2 * i) ^ S16)) = output[i];
+
+    /* the last sample lands past the 32 outputs, where the next InnerLoop
+     * overwrites it: only the one of the last InnerLoop of a chunk remains,
+     * past the staging output, and it must not reach RDRAM */
+    *(int16_t *)(hle->mp3_buffer + ((MP3_OUTPUT + MP3_CHUNK_SIZE) ^ S16)) = output[32];
 }
 
@@ -26,10 +26,12 @@
 
 #include "arithmetics.h"
 #include "audio.h"
+#include "audio_kernels.h"
 #include "common.h"
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "worker_pool.h"
 
 /* various constants */
 enum { SUBFRAME_SIZE = 192 };
@@ -37,6 +39,9 @@ enum { MAX_VOICES = 32 };
 
 enum { SAMPLE_BUFFER_SIZE = 0x200 };
 
+/* fast tier: voices whose 4 gains stay within this bound are skipped */
+enum { INAUDIBLE_GAIN = 0x10 }; /* -66dB */
+
 
 enum {
     SFD_VOICE_COUNT     = 0x0,
@@ -126,9 +131,68 @@ typedef struct {
 
     /* */
     int16_t subframe_740_last4[4];
+
+    /* fast tier: voices get mixed into this wide bus, which is added to
+     * the 4 subframes above with a single clamp */
+    int32_t bus[4][SUBFRAME_SIZE];
 } musyx_t;
 
-typedef void (*mix_sfx_with_main_subframes_t)(musyx_t *musyx, const int16_t *subframe,
+/* SFD block fields */
+typedef struct {
+    uint16_t sfx_index;
+    uint32_t voice_mask;
+    uint32_t state_ptr;
+    uint32_t sfx_ptr;
+
+    /* v2 only */
+    uint32_t ptr_10;
+    uint8_t  mask_14;
+    uint8_t  mask_15;
+    uint16_t mask_16;
+    uint32_t ptr_18;
+    uint32_t ptr_1c;
+    uint32_t ptr_20;
+    uint32_t ptr_24;
+} sfd_t;
+
+typedef struct {
+    uint32_t ptr1;
+    uint32_t ptr2;
+    uint16_t size1;
+    uint16_t size2;
+} catsrc_t;
+
+/* VOICE structures fields, one array per field. Voices get parsed up to
+ * the one with a non null interleaved_ptr, or MAX_VOICES of them */
+typedef struct {
+    unsigned count;
+
+    /* set when voices get parsed one at a time, see parse_voices */
+    bool one_by_one;
+
+    int32_t  env[MAX_VOICES][4];
+    int32_t  env_step[MAX_VOICES][4];
+    uint16_t pitch_q16[MAX_VOICES];
+    uint16_t pitch_shift[MAX_VOICES];
+    catsrc_t catsrc[2][MAX_VOICES];
+    uint8_t  adpcm_frames[2][MAX_VOICES];
+    uint8_t  skip_samples[2][MAX_VOICES];
+
+    /* for PCM16 */
+    uint16_t u16_40[MAX_VOICES];
+    uint16_t u16_42[MAX_VOICES];
+
+    /* for ADPCM */
+    uint32_t adpcm_table_ptr[MAX_VOICES];
+
+    uint32_t interleaved_ptr[MAX_VOICES];
+    uint16_t end_point[MAX_VOICES];
+    uint16_t restart_point[MAX_VOICES];
+    uint16_t u16_4e[MAX_VOICES];
+} voices_t;
+
+typedef void (*mix_sfx_with_main_subframes_t)(const struct audio_kernels_t *kernels,
+                                              musyx_t *musyx, const int16_t *subframe,
                                               const uint16_t* gains);
 
 /* helper functions prototypes */
@@ -141,42 +205,57 @@ static void update_base_vol(struct hle_t* hle, int32_t *base_vol,
 static void init_subframes_v1(musyx_t *musyx);
 static void init_subframes_v2(musyx_t *musyx);
 
+static void parse_sfd(struct hle_t* hle, sfd_t *sfd, uint32_t sfd_ptr, size_t size);
+static void parse_voices(struct hle_t* hle, voices_t *voices,
+                         uint32_t voice_ptr, uint32_t last_sample_ptr);
+
 static uint32_t voice_stage(struct hle_t* hle, musyx_t *musyx,
                             uint32_t voice_ptr, uint32_t last_sample_ptr);
 
-static void dma_cat8(struct hle_t* hle, uint8_t *dst, uint32_t catsrc_ptr);
-static void dma_cat16(struct hle_t* hle, uint16_t *dst, uint32_t catsrc_ptr);
+static void dma_cat8(struct hle_t* hle, struct worker_pool_t *pool,
+                     uint8_t *dst, const catsrc_t *catsrc);
+static void dma_cat16(struct hle_t* hle, struct worker_pool_t *pool,
+                      uint16_t *dst, const catsrc_t *catsrc);
 
-static void load_samples_PCM16(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+static void load_samples_PCM16(struct hle_t* hle, struct worker_pool_t *pool,
+                               const voices_t *voices, unsigned i, int16_t *samples,
                                unsigned *segbase, unsigned *offset);
-static void load_samples_ADPCM(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+static void load_samples_ADPCM(struct hle_t* hle, struct worker_pool_t *pool,
+                               const voices_t *voices, unsigned i, int16_t *samples,
                                unsigned *segbase, unsigned *offset);
 
-static void adpcm_decode_frames(struct hle_t* hle,
+static void adpcm_decode_frames(struct hle_t* hle, struct worker_pool_t *pool,
                                 int16_t *dst, const uint8_t *src,
-                                const int16_t *table, uint8_t count,
-                                uint8_t skip_samples);
+                                const int16_t *table,
+                                struct adpcm_predictor_t *predictor,
+                                uint8_t count, uint8_t skip_samples);
 
-static void adpcm_predict_frame(int16_t *dst, const uint8_t *src,
+static void adpcm_predict_frame(const struct audio_kernels_t *kernels,
+                                int16_t *dst, const uint8_t *src,
                                 const uint8_t *nibbles,
                                 unsigned int rshift);
 
+static void resample_voice(struct hle_t* hle, struct worker_pool_t *pool,
+                           const voices_t *voices, unsigned index, int16_t *v);
+
 static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
-                              uint32_t voice_ptr, const int16_t *samples,
-                              unsigned segbase, unsigned offset, uint32_t last_sample_ptr);
+                              const voices_t *voices, unsigned i, const int16_t *v,
+                              uint32_t last_sample_ptr);
 
 static void sfx_stage(struct hle_t* hle,
                       mix_sfx_with_main_subframes_t mix_sfx_with_main_subframes,
                       musyx_t *musyx, uint32_t sfx_ptr, uint16_t idx);
 
-static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subframe,
+static void mix_sfx_with_main_subframes_v1(const struct audio_kernels_t *kernels,
+                                           musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains);
-static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
+static void mix_sfx_with_main_subframes_v2(const struct audio_kernels_t *kernels,
+                                           musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains);
 
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain);
-static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain);
-static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs);
+static void mix_fir4(const struct audio_kernels_t *kernels,
+                     int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs);
 
 
 static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx,
@@ -186,17 +265,6 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
                                 uint16_t mask_16, uint32_t ptr_18,
                                 uint32_t ptr_1c, uint32_t output_ptr);
 
-static int32_t dot4(const int16_t *x, const int16_t *y)
-{
-    size_t i;
-    int32_t accu = 0;
-
-    for (i = 0; i < 4; ++i)
-        accu = clamp_s16(accu + (((int32_t)x[i] * (int32_t)y[i]) >> 15));
-
-    return accu;
-}
-
 /**************************************************************************
  * MusyX v1 audio ucode
  **************************************************************************/
@@ -204,7 +272,7 @@ void musyx_v1_task(struct hle_t* hle)
 {
     uint32_t sfd_ptr   = *dmem_u32(hle, TASK_DATA_PTR);
     uint32_t sfd_count = *dmem_u32(hle, TASK_DATA_SIZE);
-    uint32_t state_ptr;
+    sfd_t sfd;
     musyx_t musyx;
 
     HleVerboseMessage(hle->user_defined,
@@ -212,25 +280,21 @@ void musyx_v1_task(struct hle_t* hle)
                       sfd_ptr,
                       sfd_count);
 
-    state_ptr = *dram_u32(hle, sfd_ptr + SFD_STATE_PTR);
+    parse_sfd(hle, &sfd, sfd_ptr, SFD_VOICES);
 
     /* load initial state */
-    load_base_vol(hle, musyx.base_vol, state_ptr + STATE_BASE_VOL);
-    dram_load_u16(hle, (uint16_t *)musyx.cc0, state_ptr + STATE_CC0, SUBFRAME_SIZE);
-    dram_load_u16(hle, (uint16_t *)musyx.subframe_740_last4, state_ptr + STATE_740_LAST4_V1,
+    load_base_vol(hle, musyx.base_vol, sfd.state_ptr + STATE_BASE_VOL);
+    dram_load_u16(hle, (uint16_t *)musyx.cc0, sfd.state_ptr + STATE_CC0, SUBFRAME_SIZE);
+    dram_load_u16(hle, (uint16_t *)musyx.subframe_740_last4, sfd.state_ptr + STATE_740_LAST4_V1,
              4);
 
     for (;;) {
-        /* parse SFD structure */
-        uint16_t sfx_index   = *dram_u16(hle, sfd_ptr + SFD_SFX_INDEX);
-        uint32_t voice_mask  = *dram_u32(hle, sfd_ptr + SFD_VOICE_BITMASK);
-        uint32_t sfx_ptr     = *dram_u32(hle, sfd_ptr + SFD_SFX_PTR);
         uint32_t voice_ptr       = sfd_ptr + SFD_VOICES;
-        uint32_t last_sample_ptr = state_ptr + STATE_LAST_SAMPLE;
+        uint32_t last_sample_ptr = sfd.state_ptr + STATE_LAST_SAMPLE;
         uint32_t output_ptr;
 
         /* initialize internal subframes using updated base volumes */
-        update_base_vol(hle, musyx.base_vol, voice_mask, last_sample_ptr, 0, 0);
+        update_base_vol(hle, musyx.base_vol, sfd.voice_mask, last_sample_ptr, 0, 0);
         init_subframes_v1(&musyx);
 
         /* active voices get mixed into L,R,cc0,e50 subframes (optional) */
@@ -238,7 +302,7 @@ void musyx_v1_task(struct hle_t* hle)
 
         /* apply delay-based effects (optional) */
         sfx_stage(hle, mix_sfx_with_main_subframes_v1,
-                  &musyx, sfx_ptr, sfx_index);
+                  &musyx, sfd.sfx_ptr, sfd.sfx_index);
 
         /* emit interleaved L,R subframes */
         interleave_stage_v1(hle, &musyx, output_ptr);
@@ -248,13 +312,13 @@ void musyx_v1_task(struct hle_t* hle)
             break;
 
         sfd_ptr += SFD_VOICES + MAX_VOICES * VOICE_SIZE;
-        state_ptr = *dram_u32(hle, sfd_ptr + SFD_STATE_PTR);
+        parse_sfd(hle, &sfd, sfd_ptr, SFD_VOICES);
     }
 
     /* writeback updated state */
-    save_base_vol(hle, musyx.base_vol, state_ptr + STATE_BASE_VOL);
-    dram_store_u16(hle, (uint16_t *)musyx.cc0, state_ptr + STATE_CC0, SUBFRAME_SIZE);
-    dram_store_u16(hle, (uint16_t *)musyx.subframe_740_last4, state_ptr + STATE_740_LAST4_V1,
+    save_base_vol(hle, musyx.base_vol, sfd.state_ptr + STATE_BASE_VOL);
+    dram_store_u16(hle, (uint16_t *)musyx.cc0, sfd.state_ptr + STATE_CC0, SUBFRAME_SIZE);
+    dram_store_u16(hle, (uint16_t *)musyx.subframe_740_last4, sfd.state_ptr + STATE_740_LAST4_V1,
               4);
 
     rsp_break(hle, SP_STATUS_TASKDONE);
@@ -275,39 +339,30 @@ void musyx_v2_task(struct hle_t* hle)
                       sfd_count);
 
     for (;;) {
-        /* parse SFD structure */
-        uint16_t sfx_index       = *dram_u16(hle, sfd_ptr + SFD_SFX_INDEX);
-        uint32_t voice_mask      = *dram_u32(hle, sfd_ptr + SFD_VOICE_BITMASK);
-        uint32_t state_ptr       = *dram_u32(hle, sfd_ptr + SFD_STATE_PTR);
-        uint32_t sfx_ptr         = *dram_u32(hle, sfd_ptr + SFD_SFX_PTR);
+        sfd_t sfd;
+        uint32_t state_ptr;
         uint32_t voice_ptr       = sfd_ptr + SFD2_VOICES;
-
-        uint32_t ptr_10          = *dram_u32(hle, sfd_ptr + SFD2_10_PTR);
-        uint8_t  mask_14         = *dram_u8 (hle, sfd_ptr + SFD2_14_BITMASK);
-        uint8_t  mask_15         = *dram_u8 (hle, sfd_ptr + SFD2_15_BITMASK);
-        uint16_t mask_16         = *dram_u16(hle, sfd_ptr + SFD2_16_BITMASK);
-        uint32_t ptr_18          = *dram_u32(hle, sfd_ptr + SFD2_18_PTR);
-        uint32_t ptr_1c          = *dram_u32(hle, sfd_ptr + SFD2_1C_PTR);
-        uint32_t ptr_20          = *dram_u32(hle, sfd_ptr + SFD2_20_PTR);
-        uint32_t ptr_24          = *dram_u32(hle, sfd_ptr + SFD2_24_PTR);
-
-        uint32_t last_sample_ptr = state_ptr + STATE_LAST_SAMPLE;
+        uint32_t last_sample_ptr;
         uint32_t output_ptr;
 
+        parse_sfd(hle, &sfd, sfd_ptr, SFD2_VOICES);
+        state_ptr       = sfd.state_ptr;
+        last_sample_ptr = state_ptr + STATE_LAST_SAMPLE;
+
         /* load state */
         load_base_vol(hle, musyx.base_vol, state_ptr + STATE_BASE_VOL);
         dram_load_u16(hle, (uint16_t *)musyx.subframe_740_last4,
                 state_ptr + STATE_740_LAST4_V2, 4);
 
         /* initialize internal subframes using updated base volumes */
-        update_base_vol(hle, musyx.base_vol, voice_mask, last_sample_ptr, mask_15, ptr_24);
+        update_base_vol(hle, musyx.base_vol, sfd.voice_mask, last_sample_ptr, sfd.mask_15, sfd.ptr_24);
         init_subframes_v2(&musyx);
 
-        if (ptr_10) {
+        if (sfd.ptr_10) {
             /* TODO */
             HleWarnMessage(hle->user_defined,
                            "ptr_10=%08x mask_14=%02x ptr_24=%08x",
-                           ptr_10, mask_14, ptr_24);
+                           sfd.ptr_10, sfd.mask_14, sfd.ptr_24);
         }
 
         /* active voices get mixed into L,R,cc0,e50 subframes (optional) */
@@ -315,7 +370,7 @@ void musyx_v2_task(struct hle_t* hle)
 
         /* apply delay-based effects (optional) */
         sfx_stage(hle, mix_sfx_with_main_subframes_v2,
-                  &musyx, sfx_ptr, sfx_index);
+                  &musyx, sfd.sfx_ptr, sfd.sfx_index);
 
         dram_store_u16(hle, (uint16_t*)musyx.left,  output_ptr                  , SUBFRAME_SIZE);
         dram_store_u16(hle, (uint16_t*)musyx.right, output_ptr + 2*SUBFRAME_SIZE, SUBFRAME_SIZE);
@@ -326,8 +381,8 @@ void musyx_v2_task(struct hle_t* hle)
         dram_store_u16(hle, (uint16_t*)musyx.subframe_740_last4,
                 state_ptr + STATE_740_LAST4_V2, 4);
 
-        if (mask_16)
-            interleave_stage_v2(hle, &musyx, mask_16, ptr_18, ptr_1c, ptr_20);
+        if (sfd.mask_16)
+            interleave_stage_v2(hle, &musyx, sfd.mask_16, sfd.ptr_18, sfd.ptr_1c, sfd.ptr_20);
 
         --sfd_count;
         if (sfd_count == 0)
@@ -455,66 +510,354 @@ static void init_subframes_v2(musyx_t *musyx)
     }
 }
 
+/* load size bytes at address with a single transfer, from the preceding
+ * DRAM word. Returns the offset of address within raw: fields must be read
+ * from raw at that offset plus their own, so that u8 and u16 swizzle them
+ * as they would in DRAM */
+static unsigned load_raw(struct hle_t* hle, uint32_t *raw, uint32_t address, size_t size)
+{
+    const unsigned delta = address & 3;
+    const uint32_t base = (address & 0xffffff) - delta;
+    const size_t count = (delta + size + 3) / 4;
+    size_t head = (0x1000000 - base) / 4;
+
+    if (head > count)
+        head = count;
+
+    dram_load_u32(hle, raw, base, head);
+
+    /* wrap around the 16MB address space */
+    if (head < count)
+        dram_load_u32(hle, raw + head, 0, count - head);
+
+    return delta;
+}
+
+/* parse SFD structure, size being SFD_VOICES or SFD2_VOICES */
+static void parse_sfd(struct hle_t* hle, sfd_t *sfd, uint32_t sfd_ptr, size_t size)
+{
+    uint32_t raw[SFD2_VOICES / 4 + 1];
+    const unsigned char *sfd_raw = (const unsigned char *)raw;
+    const unsigned offset = load_raw(hle, raw, sfd_ptr, size);
+
+    sfd->sfx_index  = *u16(sfd_raw, offset + SFD_SFX_INDEX);
+    sfd->voice_mask = *u32(sfd_raw, offset + SFD_VOICE_BITMASK);
+    sfd->state_ptr  = *u32(sfd_raw, offset + SFD_STATE_PTR);
+    sfd->sfx_ptr    = *u32(sfd_raw, offset + SFD_SFX_PTR);
+
+    if (size < SFD2_VOICES)
+        return;
+
+    sfd->ptr_10  = *u32(sfd_raw, offset + SFD2_10_PTR);
+    sfd->mask_14 = *u8 (sfd_raw, offset + SFD2_14_BITMASK);
+    sfd->mask_15 = *u8 (sfd_raw, offset + SFD2_15_BITMASK);
+    sfd->mask_16 = *u16(sfd_raw, offset + SFD2_16_BITMASK);
+    sfd->ptr_18  = *u32(sfd_raw, offset + SFD2_18_PTR);
+    sfd->ptr_1c  = *u32(sfd_raw, offset + SFD2_1C_PTR);
+    sfd->ptr_20  = *u32(sfd_raw, offset + SFD2_20_PTR);
+    sfd->ptr_24  = *u32(sfd_raw, offset + SFD2_24_PTR);
+}
+
+static void parse_catsrc(catsrc_t *catsrc, const unsigned char *raw, unsigned catsrc_offset)
+{
+    catsrc->ptr1  = *u32(raw, catsrc_offset + CATSRC_PTR1);
+    catsrc->ptr2  = *u32(raw, catsrc_offset + CATSRC_PTR2);
+    catsrc->size1 = *u16(raw, catsrc_offset + CATSRC_SIZE1);
+    catsrc->size2 = *u16(raw, catsrc_offset + CATSRC_SIZE2);
+}
+
+static bool ranges_overlap(uint32_t a, uint32_t a_size, uint32_t b, uint32_t b_size)
+{
+    return a < b + b_size && b < a + a_size;
+}
+
+/* parse VOICE structures at voice_ptr with a single transfer.
+ * A voice stores its last sample at last_sample_ptr once processed: if
+ * that could modify the structures of the next voices, they get parsed
+ * one at a time instead, as they come */
+static void parse_voices(struct hle_t* hle, voices_t *voices,
+                         uint32_t voice_ptr, uint32_t last_sample_ptr)
+{
+    uint32_t raw[(MAX_VOICES * VOICE_SIZE) / 4 + 1];
+    const unsigned char *voices_raw = (const unsigned char *)raw;
+    unsigned offset;
+    unsigned max = MAX_VOICES;
+    unsigned i;
+
+    voices->one_by_one = ranges_overlap(voice_ptr, MAX_VOICES * VOICE_SIZE,
+                                        last_sample_ptr, MAX_VOICES * 8);
+    if (voices->one_by_one)
+        max = 1;
+
+    offset = load_raw(hle, raw, voice_ptr, max * VOICE_SIZE);
+
+    for (i = 0; i < max; ++i) {
+        const unsigned voice = offset + i * VOICE_SIZE;
+        int k;
+
+        for (k = 0; k < 4; ++k) {
+            voices->env[i][k]      = *u32(voices_raw, voice + VOICE_ENV_BEGIN + k * 4);
+            voices->env_step[i][k] = *u32(voices_raw, voice + VOICE_ENV_STEP  + k * 4);
+        }
+
+        voices->pitch_q16[i]   = *u16(voices_raw, voice + VOICE_PITCH_Q16);
+        voices->pitch_shift[i] = *u16(voices_raw, voice + VOICE_PITCH_SHIFT);
+
+        parse_catsrc(&voices->catsrc[0][i], voices_raw, voice + VOICE_CATSRC_0);
+        parse_catsrc(&voices->catsrc[1][i], voices_raw, voice + VOICE_CATSRC_1);
+
+        voices->adpcm_frames[0][i] = *u8(voices_raw, voice + VOICE_ADPCM_FRAMES);
+        voices->adpcm_frames[1][i] = *u8(voices_raw, voice + VOICE_ADPCM_FRAMES + 1);
+        voices->skip_samples[0][i] = *u8(voices_raw, voice + VOICE_SKIP_SAMPLES);
+        voices->skip_samples[1][i] = *u8(voices_raw, voice + VOICE_SKIP_SAMPLES + 1);
+
+        voices->u16_40[i]          = *u16(voices_raw, voice + VOICE_U16_40);
+        voices->u16_42[i]          = *u16(voices_raw, voice + VOICE_U16_42);
+        voices->adpcm_table_ptr[i] = *u32(voices_raw, voice + VOICE_ADPCM_TABLE_PTR);
+
+        voices->interleaved_ptr[i] = *u32(voices_raw, voice + VOICE_INTERLEAVED_PTR);
+        voices->end_point[i]       = *u16(voices_raw, voice + VOICE_END_POINT);
+        voices->restart_point[i]   = *u16(voices_raw, voice + VOICE_RESTART_POINT);
+        voices->u16_4e[i]          = *u16(voices_raw, voice + VOICE_U16_4E);
+
+        if (voices->interleaved_ptr[i] != 0) {
+            ++i;
+            break;
+        }
+    }
+
+    voices->count = i;
+}
+
 /* Process voices, and returns interleaved subframe destination address */
+static bool voice_is_inaudible(const voices_t *voices, unsigned i)
+{
+    int k;
+
+    /* envelopes are linear ramps: checking both ends is enough */
+    for (k = 0; k < 4; ++k) {
+        int64_t first = voices->env[i][k];
+        int64_t last = first + (int64_t)voices->env_step[i][k] * (SUBFRAME_SIZE - 1);
+
+        if (first < -(INAUDIBLE_GAIN << 16) || first >= ((INAUDIBLE_GAIN + 1) << 16)
+         || last  < -(INAUDIBLE_GAIN << 16) || last  >= ((INAUDIBLE_GAIN + 1) << 16))
+            return false;
+    }
+
+    return true;
+}
+
+static void flush_bus(musyx_t *musyx)
+{
+    int16_t *subframes[4];
+    int i, k;
+
+    subframes[0] = musyx->left;
+    subframes[1] = musyx->right;
+    subframes[2] = musyx->cc0;
+    subframes[3] = musyx->e50;
+
+    for (k = 0; k < 4; ++k) {
+        for (i = 0; i < SUBFRAME_SIZE; ++i)
+            subframes[k][i] = clamp_s16(subframes[k][i] + musyx->bus[k][i]);
+    }
+}
+
+static void skip_inaudible_voice(struct hle_t* hle, int i, uint32_t last_sample_ptr)
+{
+    static const uint16_t silence[4] = { 0, 0, 0, 0 };
+
+    HleVerboseMessage(hle->user_defined, "Skipping inaudible Voice #%d", i);
+    dram_store_u16(hle, silence, last_sample_ptr + i * 8, 4);
+}
+
+static struct worker_pool_t* voice_workers(struct hle_t* hle)
+{
+    if (hle->workers == NULL) {
+        /* the task thread makes up for the last one */
+        hle->workers = worker_pool_create(hle->musyx_threads - 1);
+
+        if (hle->workers == NULL) {
+            HleWarnMessage(hle->user_defined,
+                           "Cannot start MusyX worker threads: processing voices serially");
+            hle->musyx_threads = 1;
+        }
+    }
+
+    return hle->workers;
+}
+
+/* a voice processed on the worker pool */
+struct voice_job_t
+{
+    struct hle_t* hle;
+    struct worker_pool_t* pool;
+    const voices_t* voices;
+    unsigned index;
+    bool inaudible;
+    int16_t v[SUBFRAME_SIZE];
+};
+
+static void run_voice_job(void* opaque, unsigned int index)
+{
+    struct voice_job_t *job = (struct voice_job_t *)opaque + index;
+
+    job->inaudible = hle_fast_audio(job->hle) && voice_is_inaudible(job->voices, job->index);
+
+    if (!job->inaudible)
+        resample_voice(job->hle, job->pool, job->voices, job->index, job->v);
+}
+
+/* true if a voice reads its samples or its ADPCM table from where the
+ * voices store their last sample */
+static bool voices_read_last_samples(const voices_t *voices, uint32_t last_sample_ptr)
+{
+    const uint32_t size = voices->count * 8;
+    unsigned i, k;
+
+    last_sample_ptr &= 0xffffff;
+
+    for (i = 0; i < voices->count; ++i) {
+        for (k = 0; k < 2; ++k) {
+            const catsrc_t *catsrc = &voices->catsrc[k][i];
+
+            if (ranges_overlap(catsrc->ptr1 & 0xffffff, catsrc->size1, last_sample_ptr, size)
+             || ranges_overlap(catsrc->ptr2 & 0xffffff, catsrc->size2, last_sample_ptr, size))
+                return true;
+        }
+
+        if (voices->adpcm_frames[0][i] != 0
+         && ranges_overlap(voices->adpcm_table_ptr[i] & 0xffffff, 256, last_sample_ptr, size))
+            return true;
+    }
+
+    return false;
+}
+
+/* Voices only read DRAM until their last sample gets stored, so they can be
+ * decoded and resampled concurrently into private buffers, unless a voice
+ * reads what a previous one stores. Their mixing into the subframes
+ * saturates, so it then runs in voice order.
+ * Returns false, without doing anything, if voices must run serially */
+static bool voice_stage_parallel(struct hle_t* hle, musyx_t *musyx,
+                                 const voices_t *voices, unsigned first,
+                                 uint32_t last_sample_ptr)
+{
+    struct voice_job_t jobs[MAX_VOICES];
+    struct worker_pool_t *pool;
+    unsigned i;
+
+    if (hle->musyx_threads <= 1 || hle->reference || voices->count < 2
+     || voices_read_last_samples(voices, last_sample_ptr + first * 8))
+        return false;
+
+    pool = voice_workers(hle);
+    if (pool == NULL)
+        return false;
+
+    /* the cache is allocated here so that jobs never report its
+     * allocation failure */
+    adpcm_cache_prepare(hle);
+
+    for (i = 0; i < voices->count; ++i) {
+        jobs[i].hle = hle;
+        jobs[i].pool = pool;
+        jobs[i].voices = voices;
+        jobs[i].index = i;
+    }
+
+    worker_pool_run(pool, run_voice_job, jobs, voices->count);
+
+    for (i = 0; i < voices->count; ++i) {
+        if (jobs[i].inaudible) {
+            skip_inaudible_voice(hle, first + i, last_sample_ptr);
+        } else {
+            HleVerboseMessage(hle->user_defined, "Processing Voice #%d", first + i);
+            mix_voice_samples(hle, musyx, voices, i, jobs[i].v,
+                              last_sample_ptr + (first + i) * 8);
+        }
+    }
+
+    return true;
+}
+
 static uint32_t voice_stage(struct hle_t* hle, musyx_t *musyx,
                             uint32_t voice_ptr, uint32_t last_sample_ptr)
 {
-    uint32_t output_ptr;
-    int i = 0;
+    const bool fast = hle_fast_audio(hle);
+    voices_t voices;
+    unsigned first = 0;
+    unsigned i;
+
+    parse_voices(hle, &voices, voice_ptr, last_sample_ptr);
 
     /* voice stage can be skipped if first voice has no samples */
-    if (*dram_u16(hle, voice_ptr + VOICE_CATSRC_0 + CATSRC_SIZE1) == 0) {
+    if (voices.catsrc[0][0].size1 == 0) {
         HleVerboseMessage(hle->user_defined, "Skipping Voice stage");
-        output_ptr = *dram_u32(hle, voice_ptr + VOICE_INTERLEAVED_PTR);
-    } else {
-        /* otherwise process voices until a non null output_ptr is encountered */
-        for (;;) {
-            /* load voice samples (PCM16 or APDCM) */
-            int16_t samples[SAMPLE_BUFFER_SIZE];
-            unsigned segbase;
-            unsigned offset;
-
-            HleVerboseMessage(hle->user_defined, "Processing Voice #%d", i);
-
-            if (*dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES) == 0)
-                load_samples_PCM16(hle, voice_ptr, samples, &segbase, &offset);
-            else
-                load_samples_ADPCM(hle, voice_ptr, samples, &segbase, &offset);
-
-            /* mix them with each internal subframes */
-            mix_voice_samples(hle, musyx, voice_ptr, samples, segbase, offset,
-                              last_sample_ptr + i * 8);
-
-            /* check break condition */
-            output_ptr = *dram_u32(hle, voice_ptr + VOICE_INTERLEAVED_PTR);
-            if (output_ptr != 0)
-                break;
-
-            /* next voice */
-            ++i;
-            voice_ptr += VOICE_SIZE;
+        return voices.interleaved_ptr[0];
+    }
+
+    if (fast)
+        memset(musyx->bus, 0, sizeof(musyx->bus));
+
+    /* otherwise process voices until a non null output_ptr is encountered */
+    for (;;) {
+        if (!voice_stage_parallel(hle, musyx, &voices, first, last_sample_ptr)) {
+            for (i = 0; i < voices.count; ++i) {
+                int16_t v[SUBFRAME_SIZE];
+
+                if (fast && voice_is_inaudible(&voices, i)) {
+                    skip_inaudible_voice(hle, first + i, last_sample_ptr);
+                } else {
+                    HleVerboseMessage(hle->user_defined, "Processing Voice #%d", first + i);
+
+                    resample_voice(hle, NULL, &voices, i, v);
+
+                    /* mix them with each internal subframes */
+                    mix_voice_samples(hle, musyx, &voices, i, v,
+                                      last_sample_ptr + (first + i) * 8);
+                }
+            }
         }
+
+        /* check break condition, the last sample may have modified it */
+        if (voices.one_by_one)
+            voices.interleaved_ptr[0] = *dram_u32(hle, voice_ptr + first * VOICE_SIZE
+                                                       + VOICE_INTERLEAVED_PTR);
+
+        if (voices.interleaved_ptr[voices.count - 1] != 0)
+            break;
+
+        /* next voices */
+        first += voices.count;
+        parse_voices(hle, &voices, voice_ptr + first * VOICE_SIZE,
+                     last_sample_ptr + first * 8);
     }
 
-    return output_ptr;
+    if (fast)
+        flush_bus(musyx);
+
+    return voices.interleaved_ptr[voices.count - 1];
 }
 
-static void dma_cat8(struct hle_t* hle, uint8_t *dst, uint32_t catsrc_ptr)
+static void dma_cat8(struct hle_t* hle, struct worker_pool_t *pool,
+                     uint8_t *dst, const catsrc_t *catsrc)
 {
-    uint32_t ptr1  = *dram_u32(hle, catsrc_ptr + CATSRC_PTR1);
-    uint32_t ptr2  = *dram_u32(hle, catsrc_ptr + CATSRC_PTR2);
-    uint16_t size1 = *dram_u16(hle, catsrc_ptr + CATSRC_SIZE1);
-    uint16_t size2 = *dram_u16(hle, catsrc_ptr + CATSRC_SIZE2);
+    uint32_t ptr1  = catsrc->ptr1;
+    uint32_t ptr2  = catsrc->ptr2;
+    uint16_t size1 = catsrc->size1;
+    uint16_t size2 = catsrc->size2;
 
     size_t count1 = size1;
     size_t count2 = size2;
 
-    HleVerboseMessage(hle->user_defined,
-                      "dma_cat: %08x %08x %04x %04x",
-                      ptr1,
-                      ptr2,
-                      size1,
-                      size2);
+    if (pool == NULL)
+        HleVerboseMessage(hle->user_defined,
+                          "dma_cat: %08x %08x %04x %04x",
+                          ptr1,
+                          ptr2,
+                          size1,
+                          size2);
 
     dram_load_u8(hle, dst, ptr1, count1);
 
@@ -524,22 +867,24 @@ static void dma_cat8(struct hle_t* hle, uint8_t *dst, uint32_t catsrc_ptr)
     dram_load_u8(hle, dst + count1, ptr2, count2);
 }
 
-static void dma_cat16(struct hle_t* hle, uint16_t *dst, uint32_t catsrc_ptr)
+static void dma_cat16(struct hle_t* hle, struct worker_pool_t *pool,
+                      uint16_t *dst, const catsrc_t *catsrc)
 {
-    uint32_t ptr1  = *dram_u32(hle, catsrc_ptr + CATSRC_PTR1);
-    uint32_t ptr2  = *dram_u32(hle, catsrc_ptr + CATSRC_PTR2);
-    uint16_t size1 = *dram_u16(hle, catsrc_ptr + CATSRC_SIZE1);
-    uint16_t size2 = *dram_u16(hle, catsrc_ptr + CATSRC_SIZE2);
+    uint32_t ptr1  = catsrc->ptr1;
+    uint32_t ptr2  = catsrc->ptr2;
+    uint16_t size1 = catsrc->size1;
+    uint16_t size2 = catsrc->size2;
 
     size_t count1 = size1 >> 1;
     size_t count2 = size2 >> 1;
 
-    HleVerboseMessage(hle->user_defined,
-                      "dma_cat: %08x %08x %04x %04x",
-                      ptr1,
-                      ptr2,
-                      size1,
-                      size2);
+    if (pool == NULL)
+        HleVerboseMessage(hle->user_defined,
+                          "dma_cat: %08x %08x %04x %04x",
+                          ptr1,
+                          ptr2,
+                          size1,
+                          size2);
 
     dram_load_u16(hle, dst, ptr1, count1);
 
@@ -549,74 +894,125 @@ static void dma_cat16(struct hle_t* hle, uint16_t *dst, uint32_t catsrc_ptr)
     dram_load_u16(hle, dst + count1, ptr2, count2);
 }
 
-static void load_samples_PCM16(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+static void load_samples_PCM16(struct hle_t* hle, struct worker_pool_t *pool,
+                               const voices_t *voices, unsigned i, int16_t *samples,
                                unsigned *segbase, unsigned *offset)
 {
 
-    uint8_t  u8_3e  = *dram_u8(hle, voice_ptr + VOICE_SKIP_SAMPLES);
-    uint16_t u16_40 = *dram_u16(hle, voice_ptr + VOICE_U16_40);
-    uint16_t u16_42 = *dram_u16(hle, voice_ptr + VOICE_U16_42);
+    uint8_t  u8_3e  = voices->skip_samples[0][i];
+    uint16_t u16_40 = voices->u16_40[i];
+    uint16_t u16_42 = voices->u16_42[i];
 
     unsigned count = align(u16_40 + u8_3e, 4);
 
-    HleVerboseMessage(hle->user_defined, "Format: PCM16");
+    if (pool == NULL)
+        HleVerboseMessage(hle->user_defined, "Format: PCM16");
 
     *segbase = SAMPLE_BUFFER_SIZE - count;
     *offset  = u8_3e;
 
-    dma_cat16(hle, (uint16_t *)samples + *segbase, voice_ptr + VOICE_CATSRC_0);
+    dma_cat16(hle, pool, (uint16_t *)samples + *segbase, &voices->catsrc[0][i]);
 
     if (u16_42 != 0)
-        dma_cat16(hle, (uint16_t *)samples, voice_ptr + VOICE_CATSRC_1);
+        dma_cat16(hle, pool, (uint16_t *)samples, &voices->catsrc[1][i]);
 }
 
-static void load_samples_ADPCM(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+/* load the ADPCM table at address and the predictor matrices of its
+ * codebook entries, through the codebook cache */
+static void load_adpcm_table(struct hle_t* hle, struct worker_pool_t *pool,
+                             int16_t *table, struct adpcm_predictor_t *predictor,
+                             uint32_t address)
+{
+    struct musyx_codebook_t *codebook;
+
+    address &= 0xffffff;
+
+    /* raw bytes of unaligned tables would not be contiguous */
+    if ((address & 3) != 0 || address > 0x1000000 - sizeof(codebook->raw)) {
+        dram_load_u16(hle, (uint16_t *)table, address, 128);
+
+        /* matrices get built on first use of each entry */
+        adpcm_predictor_invalidate(predictor);
+        return;
+    }
+
+    codebook = &hle->musyx_codebooks.slots[(address >> 8) & (MUSYX_CODEBOOK_SLOTS - 1)];
+
+    /* the cache is shared by the voices of the worker pool */
+    if (pool != NULL)
+        worker_pool_lock(pool);
+
+    if (!codebook->valid || codebook->address != address
+     || memcmp(codebook->raw, hle->dram + address, sizeof(codebook->raw)) != 0) {
+        dram_load_u16(hle, (uint16_t *)codebook->table, address, 128);
+        memcpy(codebook->raw, hle->dram + address, sizeof(codebook->raw));
+        adpcm_predictor_load(&codebook->predictor, codebook->table);
+        codebook->address = address;
+        codebook->valid = 1;
+    }
+
+    memcpy(table, codebook->table, sizeof(codebook->table));
+    *predictor = codebook->predictor;
+
+    if (pool != NULL)
+        worker_pool_unlock(pool);
+}
+
+static void load_samples_ADPCM(struct hle_t* hle, struct worker_pool_t *pool,
+                               const voices_t *voices, unsigned i, int16_t *samples,
                                unsigned *segbase, unsigned *offset)
 {
     /* decompressed samples cannot exceed 0x400 bytes;
      * ADPCM has a compression ratio of 5/16 */
     uint8_t buffer[SAMPLE_BUFFER_SIZE * 2 * 5 / 16];
     int16_t adpcm_table[128];
+    struct adpcm_predictor_t predictor;
 
-    uint8_t u8_3c = *dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES    );
-    uint8_t u8_3d = *dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES + 1);
-    uint8_t u8_3e = *dram_u8(hle, voice_ptr + VOICE_SKIP_SAMPLES    );
-    uint8_t u8_3f = *dram_u8(hle, voice_ptr + VOICE_SKIP_SAMPLES + 1);
-    uint32_t adpcm_table_ptr = *dram_u32(hle, voice_ptr + VOICE_ADPCM_TABLE_PTR);
+    uint8_t u8_3c = voices->adpcm_frames[0][i];
+    uint8_t u8_3d = voices->adpcm_frames[1][i];
+    uint8_t u8_3e = voices->skip_samples[0][i];
+    uint8_t u8_3f = voices->skip_samples[1][i];
+    uint32_t adpcm_table_ptr = voices->adpcm_table_ptr[i];
     unsigned count;
 
-    HleVerboseMessage(hle->user_defined, "Format: ADPCM");
+    if (pool == NULL) {
+        HleVerboseMessage(hle->user_defined, "Format: ADPCM");
+        HleVerboseMessage(hle->user_defined, "Loading ADPCM table: %08x", adpcm_table_ptr);
+    }
 
-    HleVerboseMessage(hle->user_defined, "Loading ADPCM table: %08x", adpcm_table_ptr);
-    dram_load_u16(hle, (uint16_t *)adpcm_table, adpcm_table_ptr, 128);
+    load_adpcm_table(hle, pool, adpcm_table, &predictor, adpcm_table_ptr);
 
     count = u8_3c << 5;
 
     *segbase = SAMPLE_BUFFER_SIZE - count;
     *offset  = u8_3e & 0x1f;
 
-    dma_cat8(hle, buffer, voice_ptr + VOICE_CATSRC_0);
-    adpcm_decode_frames(hle, samples + *segbase, buffer, adpcm_table, u8_3c, u8_3e);
+    dma_cat8(hle, pool, buffer, &voices->catsrc[0][i]);
+    adpcm_decode_frames(hle, pool, samples + *segbase, buffer, adpcm_table, &predictor, u8_3c, u8_3e);
 
     if (u8_3d != 0) {
-        dma_cat8(hle, buffer, voice_ptr + VOICE_CATSRC_1);
-        adpcm_decode_frames(hle, samples, buffer, adpcm_table, u8_3d, u8_3f);
+        dma_cat8(hle, pool, buffer, &voices->catsrc[1][i]);
+        adpcm_decode_frames(hle, pool, samples, buffer, adpcm_table, &predictor, u8_3d, u8_3f);
     }
 }
 
-static void adpcm_decode_frames(struct hle_t* hle,
+static void adpcm_decode_frames(struct hle_t* hle, struct worker_pool_t *pool,
                                 int16_t *dst, const uint8_t *src,
-                                const int16_t *table, uint8_t count,
-                                uint8_t skip_samples)
+                                const int16_t *table,
+                                struct adpcm_predictor_t *predictor,
+                                uint8_t count, uint8_t skip_samples)
 {
+    const struct audio_kernels_t *kernels = audio_kernels(hle);
     int16_t frame[32];
     const uint8_t *nibbles = src + 8;
     unsigned i;
     bool jump_gap = false;
+    bool hit;
 
-    HleVerboseMessage(hle->user_defined,
-                      "ADPCM decode: count=%d, skip=%d",
-                      count, skip_samples);
+    if (pool == NULL)
+        HleVerboseMessage(hle->user_defined,
+                          "ADPCM decode: count=%d, skip=%d",
+                          count, skip_samples);
 
     if (skip_samples >= 32) {
         jump_gap = true;
@@ -629,14 +1025,49 @@ static void adpcm_decode_frames(struct hle_t* hle,
 
         const int16_t *book = (c2 & 0xf0) + table;
         unsigned int rshift = (c2 & 0x0f);
-
-        adpcm_predict_frame(frame, src, nibbles, rshift);
-
-        memcpy(dst, frame, 2 * sizeof(frame[0]));
-        adpcm_compute_residuals(dst +  2, frame +  2, book, dst     , 6);
-        adpcm_compute_residuals(dst +  8, frame +  8, book, dst +  6, 8);
-        adpcm_compute_residuals(dst + 16, frame + 16, book, dst + 14, 8);
-        adpcm_compute_residuals(dst + 24, frame + 24, book, dst + 22, 8);
+        uint8_t payload[20];
+        struct adpcm_cache_key_t key;
+
+        /* frames start from the 2 samples stored in src, so they do not
+         * depend on the previous one */
+        memcpy(payload, src, 4);
+        memcpy(payload + 4, nibbles, 16);
+        adpcm_cache_key_init(&key, payload, sizeof(payload), book, NULL);
+
+        /* the cache is shared by the voices of the worker pool */
+        if (pool != NULL)
+            worker_pool_lock(pool);
+        hit = adpcm_cache_lookup(hle, &key, dst, 32);
+        if (pool != NULL)
+            worker_pool_unlock(pool);
+
+        if (!hit) {
+            const int16_t *matrix = (hle->reference)
+                ? NULL
+                : adpcm_predictor_matrix(predictor, table, c2 >> 4);
+
+            adpcm_predict_frame(kernels, frame, src, nibbles, rshift);
+
+            memcpy(dst, frame, 2 * sizeof(frame[0]));
+            if (matrix != NULL) {
+                kernels->adpcm_residuals(dst +  2, frame +  2, matrix, dst     , 6);
+                kernels->adpcm_residuals(dst +  8, frame +  8, matrix, dst +  6, 8);
+                kernels->adpcm_residuals(dst + 16, frame + 16, matrix, dst + 14, 8);
+                kernels->adpcm_residuals(dst + 24, frame + 24, matrix, dst + 22, 8);
+            }
+            else {
+                adpcm_compute_residuals(dst +  2, frame +  2, book, dst     , 6);
+                adpcm_compute_residuals(dst +  8, frame +  8, book, dst +  6, 8);
+                adpcm_compute_residuals(dst + 16, frame + 16, book, dst + 14, 8);
+                adpcm_compute_residuals(dst + 24, frame + 24, book, dst + 22, 8);
+            }
+
+            if (pool != NULL)
+                worker_pool_lock(pool);
+            adpcm_cache_store(hle, &key, dst, 32);
+            if (pool != NULL)
+                worker_pool_unlock(pool);
+        }
 
         if (jump_gap) {
             nibbles += 8;
@@ -650,55 +1081,121 @@ static void adpcm_decode_frames(struct hle_t* hle,
     }
 }
 
-static void adpcm_predict_frame(int16_t *dst, const uint8_t *src,
+static void adpcm_predict_frame(const struct audio_kernels_t *kernels,
+                                int16_t *dst, const uint8_t *src,
                                 const uint8_t *nibbles,
                                 unsigned int rshift)
 {
-    unsigned int i;
-
-    *(dst++) = (src[0] << 8) | src[1];
-    *(dst++) = (src[2] << 8) | src[3];
-
-    for (i = 1; i < 16; ++i) {
-        uint8_t byte = nibbles[i];
+    /* nibbles[0] holds the frame header, whose 2 expanded samples
+     * get replaced by the ones stored in src */
+    kernels->adpcm_expand_4bits(dst     , nibbles    , rshift);
+    kernels->adpcm_expand_4bits(dst + 16, nibbles + 8, rshift);
 
-        *(dst++) = adpcm_predict_sample(byte, 0xf0,  8, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x0f, 12, rshift);
-    }
+    dst[0] = (src[0] << 8) | src[1];
+    dst[1] = (src[2] << 8) | src[3];
 }
 
-static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
-                              uint32_t voice_ptr, const int16_t *samples,
-                              unsigned segbase, unsigned offset, uint32_t last_sample_ptr)
+/* load voice samples (PCM16 or ADPCM) and resample them into v */
+static void resample_voice(struct hle_t* hle, struct worker_pool_t *pool,
+                           const voices_t *voices, unsigned index, int16_t *v)
 {
-    int i, k;
-
-    /* parse VOICE structure */
-    const uint16_t pitch_q16   = *dram_u16(hle, voice_ptr + VOICE_PITCH_Q16);
-    const uint16_t pitch_shift = *dram_u16(hle, voice_ptr + VOICE_PITCH_SHIFT); /* Q4.12 */
+    const bool fast = hle_fast_audio(hle);
+    int16_t samples[SAMPLE_BUFFER_SIZE];
+    unsigned segbase;
+    unsigned offset;
+    int i;
 
-    const uint16_t end_point     = *dram_u16(hle, voice_ptr + VOICE_END_POINT);
-    const uint16_t restart_point = *dram_u16(hle, voice_ptr + VOICE_RESTART_POINT);
+    const uint16_t pitch_q16   = voices->pitch_q16[index];
+    const uint16_t pitch_shift = voices->pitch_shift[index]; /* Q4.12 */
 
-    const uint16_t u16_4e = *dram_u16(hle, voice_ptr + VOICE_U16_4E);
+    const uint16_t end_point     = voices->end_point[index];
+    const uint16_t restart_point = voices->restart_point[index];
 
-    /* init values and pointers */
-    const int16_t       *sample         = samples + segbase + offset + u16_4e;
-    const int16_t *const sample_end     = samples + segbase + end_point;
-    const int16_t *const sample_restart = samples + (restart_point & 0x7fff) +
-                                          (((restart_point & 0x8000) != 0) ? 0x000 : segbase);
+    const uint16_t u16_4e = voices->u16_4e[index];
 
+    const int16_t *sample;
+    const int16_t *sample_end;
+    const int16_t *sample_restart;
 
     uint32_t pitch_accu = pitch_q16;
     uint32_t pitch_step = pitch_shift << 4;
 
+    /* resampler taps and lut rows */
+    int16_t x[4 * SUBFRAME_SIZE];
+    int16_t h[4 * SUBFRAME_SIZE];
+
+    if (voices->adpcm_frames[0][index] == 0)
+        load_samples_PCM16(hle, pool, voices, index, samples, &segbase, &offset);
+    else
+        load_samples_ADPCM(hle, pool, voices, index, samples, &segbase, &offset);
+
+    /* init values and pointers */
+    sample         = samples + segbase + offset + u16_4e;
+    sample_end     = samples + segbase + end_point;
+    sample_restart = samples + (restart_point & 0x7fff) +
+                     (((restart_point & 0x8000) != 0) ? 0x000 : segbase);
+
+    if (pool == NULL)
+        HleVerboseMessage(hle->user_defined,
+                          "Voice debug: segbase=%d"
+                          "\tu16_4e=%04x\n"
+                          "\tpitch: frac0=%04x shift=%04x\n"
+                          "\tend_point=%04x restart_point=%04x\n",
+                          segbase,
+                          u16_4e,
+                          pitch_q16, pitch_shift,
+                          end_point, restart_point);
+
+    /* apply resample filter.
+     * At unity pitch, as long as the end point is not reached, lut phase
+     * stays the same and samples are contiguous: this is a constant FIR */
+    if (pitch_step == 0x10000 && sample_end - sample >= SUBFRAME_SIZE) {
+        audio_kernels(hle)->fir4_sat(v, sample, SUBFRAME_SIZE,
+                                     RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
+    }
+    else {
+        for (i = 0; i < SUBFRAME_SIZE; ++i) {
+            /* update sample and lut pointers and then pitch_accu */
+            const int16_t *lut = (RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
+            const uint16_t frac = pitch_accu;
+            int dist;
+
+            sample += (pitch_accu >> 16);
+            pitch_accu &= 0xffff;
+            pitch_accu += pitch_step;
+
+            /* handle end/restart points */
+            dist = sample - sample_end;
+            if (dist >= 0)
+                sample = sample_restart + dist;
+
+            if (fast) {
+                v[i] = resample_linear_sample(sample[1], sample[2], frac);
+            } else {
+                memcpy(&x[4 * i], sample, 4 * sizeof(x[0]));
+                memcpy(&h[4 * i], lut,    4 * sizeof(h[0]));
+            }
+        }
+
+        if (!fast)
+            audio_kernels(hle)->dot4_sat(v, x, h, SUBFRAME_SIZE);
+    }
+}
+
+/* mix resampled voice samples with each internal subframes */
+static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
+                              const voices_t *voices, unsigned i, const int16_t *v,
+                              uint32_t last_sample_ptr)
+{
+    int k;
+
     int32_t  v4_env[4];
-    int32_t  v4_env_step[4];
+    const int32_t *v4_env_step = voices->env_step[i];
     int16_t *v4_dst[4];
     int16_t  v4[4];
 
-    dram_load_u32(hle, (uint32_t *)v4_env,      voice_ptr + VOICE_ENV_BEGIN, 4);
-    dram_load_u32(hle, (uint32_t *)v4_env_step, voice_ptr + VOICE_ENV_STEP,  4);
+    /* envelopes get stepped by the mixer */
+    memcpy(v4_env, voices->env[i], sizeof(v4_env));
 
     v4_dst[0] = musyx->left;
     v4_dst[1] = musyx->right;
@@ -706,49 +1203,28 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
     v4_dst[3] = musyx->e50;
 
     HleVerboseMessage(hle->user_defined,
-                      "Voice debug: segbase=%d"
-                      "\tu16_4e=%04x\n"
-                      "\tpitch: frac0=%04x shift=%04x\n"
-                      "\tend_point=%04x restart_point=%04x\n"
+                      "Voice envelopes:\n"
                       "\tenv      = %08x %08x %08x %08x\n"
                       "\tenv_step = %08x %08x %08x %08x\n",
-                      segbase,
-                      u16_4e,
-                      pitch_q16, pitch_shift,
-                      end_point, restart_point,
                       v4_env[0],      v4_env[1],      v4_env[2],      v4_env[3],
                       v4_env_step[0], v4_env_step[1], v4_env_step[2], v4_env_step[3]);
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
-        /* update sample and lut pointers and then pitch_accu */
-        const int16_t *lut = (RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
-        int dist;
-        int16_t v;
-
-        sample += (pitch_accu >> 16);
-        pitch_accu &= 0xffff;
-        pitch_accu += pitch_step;
+    if (hle_fast_audio(hle)) {
+        /* accumulated without clamping, see flush_bus */
+        int32_t *bus[4];
 
-        /* handle end/restart points */
-        dist = sample - sample_end;
-        if (dist >= 0)
-            sample = sample_restart + dist;
+        for (k = 0; k < 4; ++k)
+            bus[k] = musyx->bus[k];
 
-        /* apply resample filter */
-        v = clamp_s16(dot4(sample, lut));
-
-        for (k = 0; k < 4; ++k) {
-            /* envmix */
-            int32_t accu = (v * (v4_env[k] >> 16)) >> 15;
-            v4[k] = clamp_s16(accu);
-            *(v4_dst[k]) = clamp_s16(accu + *(v4_dst[k]));
-
-            /* update envelopes and dst pointers */
-            ++(v4_dst[k]);
-            v4_env[k] += v4_env_step[k];
-        }
+        audio_kernels(hle)->musyx_envmix_wide(bus, v, SUBFRAME_SIZE, v4_env, v4_env_step);
+    } else {
+        audio_kernels(hle)->musyx_envmix(v4_dst, v, SUBFRAME_SIZE, v4_env, v4_env_step);
     }
 
+    /* last resampled sample, from the envelopes of the last step */
+    for (k = 0; k < 4; ++k)
+        v4[k] = clamp_s16((v[SUBFRAME_SIZE - 1] * ((v4_env[k] - v4_env_step[k]) >> 16)) >> 15);
+
     /* save last resampled sample */
     dram_store_u16(hle, (uint16_t *)v4, last_sample_ptr, 4);
 
@@ -758,6 +1234,31 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
 }
 
 
+/* delayed subframe of the SFX circular buffer, as pair-swapped samples.
+ * It gets read in place, unless it wraps around or does not start on a
+ * DRAM sample pair: it is then staged into buffer */
+static const int16_t *load_sfx_tap(struct hle_t* hle, int16_t *buffer,
+                                   uint32_t cbuffer_ptr, uint32_t cbuffer_length, int dpos)
+{
+    const uint32_t address = (cbuffer_ptr + dpos * 2) & 0xffffff;
+    int dlength = SUBFRAME_SIZE;
+    int j;
+
+    if ((uint32_t)(dpos + SUBFRAME_SIZE) > cbuffer_length)
+        dlength = cbuffer_length - dpos;
+
+    if (dlength == SUBFRAME_SIZE && (address & 3) == 0
+     && address <= 0x1000000 - SUBFRAME_SIZE * 2)
+        return (const int16_t *)(hle->dram + address);
+
+    for (j = 0; j < dlength; ++j)
+        buffer[j ^ S] = *dram_u16(hle, address + j * 2);
+    for (; j < SUBFRAME_SIZE; ++j)
+        buffer[j ^ S] = *dram_u16(hle, cbuffer_ptr + (j - dlength) * 2);
+
+    return buffer;
+}
+
 static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_with_main_subframes,
                       musyx_t *musyx, uint32_t sfx_ptr, uint16_t idx)
 {
@@ -770,8 +1271,10 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
     int16_t tap_gains[8];
     int16_t fir4_hcoeffs[4];
 
-    int16_t delayed[SUBFRAME_SIZE];
-    int dpos, dlength;
+    /* delayed subframes, pair-swapped as in DRAM */
+    const int16_t *taps[8];
+    int16_t staged[8][SUBFRAME_SIZE];
+    int dpos;
 
     const uint32_t pos = idx * SUBFRAME_SIZE;
 
@@ -781,6 +1284,8 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
     int16_t fir4_hgain;
     uint16_t sfx_gains[2];
 
+    const struct audio_kernels_t *kernels = audio_kernels(hle);
+
     HleVerboseMessage(hle->user_defined, "SFX: %08x, idx=%d", sfx_ptr, idx);
 
     if (sfx_ptr == 0)
@@ -822,6 +1327,11 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
 
     HleVerboseMessage(hle->user_defined, "sfx_gains=%04x %04x", sfx_gains[0], sfx_gains[1]);
 
+    if (tap_count > 8) {
+        HleVerboseMessage(hle->user_defined, "SFX: ignoring taps beyond the 8th of %d", tap_count);
+        tap_count = 8;
+    }
+
     /* mix up to 8 delayed subframes */
     memset(subframe, 0, SUBFRAME_SIZE * sizeof(subframe[0]));
     for (i = 0; i < tap_count; ++i) {
@@ -829,54 +1339,37 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
         dpos = pos - tap_delays[i];
         if (dpos <= 0)
             dpos += cbuffer_length;
-        dlength = SUBFRAME_SIZE;
-
-        if ((uint32_t)(dpos + SUBFRAME_SIZE) > cbuffer_length) {
-            dlength = cbuffer_length - dpos;
-            dram_load_u16(hle, (uint16_t *)delayed + dlength, cbuffer_ptr, SUBFRAME_SIZE - dlength);
-        }
 
-        dram_load_u16(hle, (uint16_t *)delayed, cbuffer_ptr + dpos * 2, dlength);
-
-        mix_subframes(subframe, delayed, tap_gains[i]);
+        taps[i] = load_sfx_tap(hle, staged[i], cbuffer_ptr, cbuffer_length, dpos);
     }
 
+    kernels->musyx_sfx_taps(subframe, taps, tap_gains, tap_count, SUBFRAME_SIZE);
+
     /* add resulting subframe to main subframes */
-    mix_sfx_with_main_subframes(musyx, subframe, sfx_gains);
+    mix_sfx_with_main_subframes(kernels, musyx, subframe, sfx_gains);
 
     /* apply FIR4 filter and writeback filtered result */
     memcpy(buffer, musyx->subframe_740_last4, 4 * sizeof(int16_t));
     memcpy(musyx->subframe_740_last4, subframe + SUBFRAME_SIZE - 4, 4 * sizeof(int16_t));
-    mix_fir4(musyx->e50, buffer + 1, fir4_hgain, fir4_hcoeffs);
+    mix_fir4(kernels, musyx->e50, buffer + 1, fir4_hgain, fir4_hcoeffs);
     dram_store_u16(hle, (uint16_t *)musyx->e50, cbuffer_ptr + pos * 2, SUBFRAME_SIZE);
 }
 
-static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subframe,
+static void mix_sfx_with_main_subframes_v1(const struct audio_kernels_t *kernels,
+                                           musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* UNUSED(gains))
 {
-    unsigned i;
-
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
-        int16_t v = subframe[i];
-        musyx->left[i]  = clamp_s16(musyx->left[i]  + v);
-        musyx->right[i] = clamp_s16(musyx->right[i] + v);
-    }
+    kernels->add(musyx->left,  subframe, SUBFRAME_SIZE);
+    kernels->add(musyx->right, subframe, SUBFRAME_SIZE);
 }
 
-static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
+static void mix_sfx_with_main_subframes_v2(const struct audio_kernels_t *kernels,
+                                           musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains)
 {
-    unsigned i;
-
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
-        int16_t v = subframe[i];
-        int16_t v1 = (int32_t)(v * gains[0]) >> 16;
-        int16_t v2 = (int32_t)(v * gains[1]) >> 16;
-
-        musyx->left[i]  = clamp_s16(musyx->left[i]  + v1);
-        musyx->right[i] = clamp_s16(musyx->right[i] + v1);
-        musyx->cc0[i]   = clamp_s16(musyx->cc0[i]   + v2);
-    }
+    kernels->mix_high(musyx->left,  subframe, SUBFRAME_SIZE, gains[0]);
+    kernels->mix_high(musyx->right, subframe, SUBFRAME_SIZE, gains[0]);
+    kernels->mix_high(musyx->cc0,   subframe, SUBFRAME_SIZE, gains[1]);
 }
 
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
@@ -884,17 +1377,9 @@ static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
     *y = clamp_s16(*y + ((x * hgain + 0x4000) >> 15));
 }
 
-static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain)
-{
-    unsigned int i;
-
-    for (i = 0; i < SUBFRAME_SIZE; ++i)
-        mix_samples(&y[i], x[i], hgain);
-}
-
-static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
+static void mix_fir4(const struct audio_kernels_t *kernels,
+                     int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
 {
-    unsigned int i;
     int32_t h[4];
 
     h[0] = (hgain * hcoeffs[0]) >> 15;
@@ -902,10 +1387,7 @@ static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t
     h[2] = (hgain * hcoeffs[2]) >> 15;
     h[3] = (hgain * hcoeffs[3]) >> 15;
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
-        int32_t v = (h[0] * x[i] + h[1] * x[i + 1] + h[2] * x[i + 2] + h[3] * x[i + 3]) >> 15;
-        y[i] = clamp_s16(y[i] + v);
-    }
+    kernels->musyx_fir4(y, x, SUBFRAME_SIZE, h);
 }
 
 static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx, uint32_t output_ptr)
@@ -934,6 +1416,8 @@ static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx, uint32_t outp
 
         *(dst++) = (l << 16) | r;
     }
+
+    audio_tap_emit(hle, output_ptr & 0xffffff, SUBFRAME_SIZE * sizeof(dst[0]));
 }
 
 static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
@@ -983,6 +1467,8 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
         *(dst++) = (l << 16) | r;
     }
 
+    audio_tap_emit(hle, output_ptr & 0xffffff, SUBFRAME_SIZE * sizeof(dst[0]));
+
     /* writeback subframe @ptr_1c */
     dram_store_u16(hle, (uint16_t*)subframe, ptr_1c, SUBFRAME_SIZE);
 }
@@ -0,0 +1,44 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - osal_thread.h                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if !defined(OSAL_THREAD_H)
+#define OSAL_THREAD_H
+
+/* minimal threading primitives, all functions returning NULL on failure */
+
+struct osal_thread_t;
+struct osal_mutex_t;
+struct osal_cond_t;
+
+struct osal_thread_t* osal_thread_create(void (*entry)(void* arg), void* arg);
+void osal_thread_join(struct osal_thread_t* thread);
+
+struct osal_mutex_t* osal_mutex_create(void);
+void osal_mutex_destroy(struct osal_mutex_t* mutex);
+void osal_mutex_lock(struct osal_mutex_t* mutex);
+void osal_mutex_unlock(struct osal_mutex_t* mutex);
+
+struct osal_cond_t* osal_cond_create(void);
+void osal_cond_destroy(struct osal_cond_t* cond);
+void osal_cond_wait(struct osal_cond_t* cond, struct osal_mutex_t* mutex);
+void osal_cond_broadcast(struct osal_cond_t* cond);
+
+#endif /* #define OSAL_THREAD_H */
@@ -0,0 +1,130 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - osal_thread_unix.c                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "osal_thread.h"
+
+struct osal_thread_t
+{
+    pthread_t thread;
+    void (*entry)(void* arg);
+    void* arg;
+};
+
+struct osal_mutex_t
+{
+    pthread_mutex_t mutex;
+};
+
+struct osal_cond_t
+{
+    pthread_cond_t cond;
+};
+
+static void* thread_entry(void* arg)
+{
+    struct osal_thread_t* thread = (struct osal_thread_t*)arg;
+
+    thread->entry(thread->arg);
+    return NULL;
+}
+
+struct osal_thread_t* osal_thread_create(void (*entry)(void* arg), void* arg)
+{
+    struct osal_thread_t* thread = malloc(sizeof(*thread));
+
+    if (thread == NULL)
+        return NULL;
+
+    thread->entry = entry;
+    thread->arg = arg;
+
+    if (pthread_create(&thread->thread, NULL, thread_entry, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void osal_thread_join(struct osal_thread_t* thread)
+{
+    pthread_join(thread->thread, NULL);
+    free(thread);
+}
+
+struct osal_mutex_t* osal_mutex_create(void)
+{
+    struct osal_mutex_t* mutex = malloc(sizeof(*mutex));
+
+    if (mutex != NULL && pthread_mutex_init(&mutex->mutex, NULL) != 0) {
+        free(mutex);
+        return NULL;
+    }
+
+    return mutex;
+}
+
+void osal_mutex_destroy(struct osal_mutex_t* mutex)
+{
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+void osal_mutex_lock(struct osal_mutex_t* mutex)
+{
+    pthread_mutex_lock(&mutex->mutex);
+}
+
+void osal_mutex_unlock(struct osal_mutex_t* mutex)
+{
+    pthread_mutex_unlock(&mutex->mutex);
+}
+
+struct osal_cond_t* osal_cond_create(void)
+{
+    struct osal_cond_t* cond = malloc(sizeof(*cond));
+
+    if (cond != NULL && pthread_cond_init(&cond->cond, NULL) != 0) {
+        free(cond);
+        return NULL;
+    }
+
+    return cond;
+}
+
+void osal_cond_destroy(struct osal_cond_t* cond)
+{
+    pthread_cond_destroy(&cond->cond);
+    free(cond);
+}
+
+void osal_cond_wait(struct osal_cond_t* cond, struct osal_mutex_t* mutex)
+{
+    pthread_cond_wait(&cond->cond, &mutex->mutex);
+}
+
+void osal_cond_broadcast(struct osal_cond_t* cond)
+{
+    pthread_cond_broadcast(&cond->cond);
+}
@@ -0,0 +1,128 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - osal_thread_win32.c                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <process.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "osal_thread.h"
+
+struct osal_thread_t
+{
+    HANDLE handle;
+    void (*entry)(void* arg);
+    void* arg;
+};
+
+struct osal_mutex_t
+{
+    CRITICAL_SECTION section;
+};
+
+struct osal_cond_t
+{
+    CONDITION_VARIABLE cond;
+};
+
+static unsigned __stdcall thread_entry(void* arg)
+{
+    struct osal_thread_t* thread = (struct osal_thread_t*)arg;
+
+    thread->entry(thread->arg);
+    return 0;
+}
+
+struct osal_thread_t* osal_thread_create(void (*entry)(void* arg), void* arg)
+{
+    struct osal_thread_t* thread = malloc(sizeof(*thread));
+
+    if (thread == NULL)
+        return NULL;
+
+    thread->entry = entry;
+    thread->arg = arg;
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, thread_entry, thread, 0, NULL);
+
+    if (thread->handle == NULL) {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void osal_thread_join(struct osal_thread_t* thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+struct osal_mutex_t* osal_mutex_create(void)
+{
+    struct osal_mutex_t* mutex = malloc(sizeof(*mutex));
+
+    if (mutex != NULL)
+        InitializeCriticalSection(&mutex->section);
+
+    return mutex;
+}
+
+void osal_mutex_destroy(struct osal_mutex_t* mutex)
+{
+    DeleteCriticalSection(&mutex->section);
+    free(mutex);
+}
+
+void osal_mutex_lock(struct osal_mutex_t* mutex)
+{
+    EnterCriticalSection(&mutex->section);
+}
+
+void osal_mutex_unlock(struct osal_mutex_t* mutex)
+{
+    LeaveCriticalSection(&mutex->section);
+}
+
+struct osal_cond_t* osal_cond_create(void)
+{
+    struct osal_cond_t* cond = malloc(sizeof(*cond));
+
+    if (cond != NULL)
+        InitializeConditionVariable(&cond->cond);
+
+    return cond;
+}
+
+void osal_cond_destroy(struct osal_cond_t* cond)
+{
+    free(cond);
+}
+
+void osal_cond_wait(struct osal_cond_t* cond, struct osal_mutex_t* mutex)
+{
+    SleepConditionVariableCS(&cond->cond, &mutex->section, INFINITE);
+}
+
+void osal_cond_broadcast(struct osal_cond_t* cond)
+{
+    WakeAllConditionVariable(&cond->cond);
+}
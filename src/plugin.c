@@ -51,6 +51,12 @@
 #define RSP_HLE_CONFIG_FALLBACK "RspFallback"
 #define RSP_HLE_CONFIG_HLE_GFX  "DisplayListToGraphicsPlugin"
 #define RSP_HLE_CONFIG_HLE_AUD  "AudioListToAudioPlugin"
+#define RSP_HLE_CONFIG_SHADOW_RATE "ShadowValidationRate"
+#define RSP_HLE_CONFIG_ADPCM_CACHE "AdpcmCacheSize"
+#define RSP_HLE_CONFIG_MEMOIZATION "AudioTaskMemoization"
+#define RSP_HLE_CONFIG_CAPTURE "AudioTaskCapture"
+#define RSP_HLE_CONFIG_ACCURACY "AudioAccuracy"
+#define RSP_HLE_CONFIG_MUSYX_THREADS "MusyXThreads"
 
 
 #define VERSION_PRINTF_SPLIT(x) (((x) >> 16) & 0xffff), (((x) >> 8) & 0xff), ((x) & 0xff)
@@ -187,6 +193,17 @@ close_handle:
     osal_dynlib_close(handle);
 }
 
+static int parse_audio_accuracy(const char* name)
+{
+    if (name != NULL && strcmp(name, "fast") == 0)
+        return HLE_AUDIO_FAST;
+
+    if (name != NULL && strcmp(name, "bit-exact") != 0)
+        HleWarnMessage(NULL, "Unknown audio accuracy '%s', using 'bit-exact'", name);
+
+    return HLE_AUDIO_BIT_EXACT;
+}
+
 static void DebugMessage(int level, const char *message, va_list args)
 {
     char msgbuf[1024];
@@ -199,40 +216,28 @@ static void DebugMessage(int level, const char *message, va_list args)
     (*l_DebugCallback)(l_DebugCallContext, level, msgbuf);
 }
 
-/* Global functions needed by HLE core */
-void HleVerboseMessage(void* UNUSED(user_defined), const char *message, ...)
+/* callbacks of the HLE core */
+static void verbose_message(void* UNUSED(user_defined), const char *message, va_list args)
 {
-    va_list args;
-    va_start(args, message);
     DebugMessage(M64MSG_VERBOSE, message, args);
-    va_end(args);
 }
 
-void HleInfoMessage(void* UNUSED(user_defined), const char *message, ...)
+static void info_message(void* UNUSED(user_defined), const char *message, va_list args)
 {
-    va_list args;
-    va_start(args, message);
     DebugMessage(M64MSG_INFO, message, args);
-    va_end(args);
 }
 
-void HleErrorMessage(void* UNUSED(user_defined), const char *message, ...)
+static void error_message(void* UNUSED(user_defined), const char *message, va_list args)
 {
-    va_list args;
-    va_start(args, message);
     DebugMessage(M64MSG_ERROR, message, args);
-    va_end(args);
 }
 
-void HleWarnMessage(void* UNUSED(user_defined), const char *message, ...)
+static void warn_message(void* UNUSED(user_defined), const char *message, va_list args)
 {
-    va_list args;
-    va_start(args, message);
     DebugMessage(M64MSG_WARNING, message, args);
-    va_end(args);
 }
 
-void HleCheckInterrupts(void* UNUSED(user_defined))
+static void check_interrupts(void* UNUSED(user_defined))
 {
     if (l_CheckInterrupts == NULL)
         return;
@@ -240,7 +245,7 @@ void HleCheckInterrupts(void* UNUSED(user_defined))
     (*l_CheckInterrupts)();
 }
 
-void HleProcessDlistList(void* UNUSED(user_defined))
+static void process_dlist_list(void* UNUSED(user_defined))
 {
     if (l_ProcessDlistList == NULL)
         return;
@@ -248,7 +253,7 @@ void HleProcessDlistList(void* UNUSED(user_defined))
     (*l_ProcessDlistList)();
 }
 
-void HleProcessAlistList(void* UNUSED(user_defined))
+static void process_alist_list(void* UNUSED(user_defined))
 {
     if (l_ProcessAlistList == NULL)
         return;
@@ -256,7 +261,7 @@ void HleProcessAlistList(void* UNUSED(user_defined))
     (*l_ProcessAlistList)();
 }
 
-void HleProcessRdpList(void* UNUSED(user_defined))
+static void process_rdp_list(void* UNUSED(user_defined))
 {
     if (l_ProcessRdpList == NULL)
         return;
@@ -264,7 +269,7 @@ void HleProcessRdpList(void* UNUSED(user_defined))
     (*l_ProcessRdpList)();
 }
 
-void HleShowCFB(void* UNUSED(user_defined))
+static void show_cfb(void* UNUSED(user_defined))
 {
     if (l_ShowCFB == NULL)
         return;
@@ -273,7 +278,7 @@ void HleShowCFB(void* UNUSED(user_defined))
 }
 
 
-int HleForwardTask(void* user_defined)
+static int forward_task(void* UNUSED(user_defined))
 {
     if (l_DoRspCycles == NULL)
         return -1;
@@ -282,6 +287,20 @@ int HleForwardTask(void* user_defined)
     return 0;
 }
 
+static const struct hle_callbacks_t l_HleCallbacks =
+{
+    verbose_message,
+    info_message,
+    error_message,
+    warn_message,
+    check_interrupts,
+    process_dlist_list,
+    process_alist_list,
+    process_rdp_list,
+    show_cfb,
+    forward_task
+};
+
 
 /* DLL-exported functions */
 EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Context,
@@ -297,6 +316,7 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     /* first thing is to set the callback function for debug info */
     l_DebugCallback = DebugCallback;
     l_DebugCallContext = Context;
+    hle_set_callbacks(&l_HleCallbacks);
 
     /* attach and call the CoreGetAPIVersions function, check Config API version for compatibility */
     CoreAPIVersionFunc = (ptr_CoreGetAPIVersions) osal_dynlib_getproc(CoreLibHandle, "CoreGetAPIVersions");
@@ -377,6 +397,22 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
         "Send display lists to the graphics plugin");
     ConfigSetDefaultBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_AUD, 0,
         "Send audio lists to the audio plugin");
+    ConfigSetDefaultInt(l_ConfigRspHle, RSP_HLE_CONFIG_SHADOW_RATE, 0,
+        "Validate 1 audio task out of N against the scalar reference implementation. "
+        "Divergent tasks are logged and captured to disk. 0 disables validation.");
+    ConfigSetDefaultInt(l_ConfigRspHle, RSP_HLE_CONFIG_ADPCM_CACHE, 0,
+        "Memory budget (in KiB) of the cache of decoded ADPCM frames. 0 disables the cache.");
+    ConfigSetDefaultBool(l_ConfigRspHle, RSP_HLE_CONFIG_MEMOIZATION, 0,
+        "Replay the results of audio lists found to run again on identical inputs instead of running them");
+    ConfigSetDefaultString(l_ConfigRspHle, RSP_HLE_CONFIG_ACCURACY, "bit-exact",
+        "Audio accuracy tier: 'bit-exact' matches the RSP audio ucodes, "
+        "'fast' uses linear resampling, a wide mix bus and skips inaudible voices.");
+    ConfigSetDefaultString(l_ConfigRspHle, RSP_HLE_CONFIG_CAPTURE, "",
+        "Path of a file recording the audio tasks, for offline rendering with mupen64plus-rsp-hle-render. "
+        "Each rom session after the first one is recorded to its own file, suffixed with .2, .3, ... "
+        "You can disable this by letting an empty string.");
+    ConfigSetDefaultInt(l_ConfigRspHle, RSP_HLE_CONFIG_MUSYX_THREADS, 1,
+        "Number of threads decoding and resampling MusyX voices. 1 processes voices serially.");
 
     l_CoreHandle = CoreLibHandle;
 
@@ -429,6 +465,11 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int Cycles)
 
 EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int* CycleCount)
 {
+    struct hle_options_t options;
+    int shadow_rate;
+    int adpcm_cache_size;
+    int musyx_threads;
+
     hle_init(&g_hle,
              Rsp_Info.RDRAM,
              Rsp_Info.DMEM,
@@ -461,8 +502,23 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int* CycleCount)
 
     setup_rsp_fallback(ConfigGetParamString(l_ConfigRspHle, RSP_HLE_CONFIG_FALLBACK));
 
-    g_hle.hle_gfx = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_GFX);
-    g_hle.hle_aud = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_AUD);
+    options.hle_gfx = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_GFX);
+    options.hle_aud = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_AUD);
+    options.audio_accuracy = parse_audio_accuracy(ConfigGetParamString(l_ConfigRspHle, RSP_HLE_CONFIG_ACCURACY));
+
+    shadow_rate = ConfigGetParamInt(l_ConfigRspHle, RSP_HLE_CONFIG_SHADOW_RATE);
+    options.shadow_rate = (shadow_rate > 0) ? (unsigned int)shadow_rate : 0;
+
+    adpcm_cache_size = ConfigGetParamInt(l_ConfigRspHle, RSP_HLE_CONFIG_ADPCM_CACHE);
+    options.adpcm_cache_size = (adpcm_cache_size > 0) ? (size_t)adpcm_cache_size * 1024 : 0;
+
+    options.memoization = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_MEMOIZATION);
+    options.capture_filename = ConfigGetParamString(l_ConfigRspHle, RSP_HLE_CONFIG_CAPTURE);
+
+    musyx_threads = ConfigGetParamInt(l_ConfigRspHle, RSP_HLE_CONFIG_MUSYX_THREADS);
+    options.musyx_threads = (musyx_threads > 0) ? (unsigned int)musyx_threads : 1;
+
+    hle_configure(&g_hle, &options);
 
     /* notify fallback plugin */
     if (l_InitiateRSP) {
@@ -470,9 +526,25 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int* CycleCount)
     }
 }
 
+EXPORT void CALL RspHleSetAudioTap(rsp_hle_audio_tap_t callback, void* context)
+{
+    hle_set_audio_tap(&g_hle, callback, context);
+}
+
+EXPORT void CALL RspHleEnableAudioTapRing(int enable)
+{
+    hle_enable_audio_tap_ring(&g_hle, enable);
+}
+
+EXPORT int CALL RspHlePopAudioTapBlock(struct rsp_hle_audio_block* block)
+{
+    return hle_pop_audio_tap_block(&g_hle, block);
+}
+
 EXPORT void CALL RomClosed(void)
 {
     g_hle.cached_ucodes.count = 0;
+    hle_release(&g_hle);
 
     /* notify fallback plugin */
     if (l_RomClosed) {
@@ -0,0 +1,57 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - rsp_hle_audio_tap.h                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef RSP_HLE_AUDIO_TAP_H
+#define RSP_HLE_AUDIO_TAP_H
+
+#include <stdint.h>
+
+/* Audio output tap: the final output blocks of audio tasks are handed over
+ * as they get written to RDRAM, either to a callback run on the emulation
+ * thread or through a single producer / single consumer ring to be drained
+ * by a consumer thread.
+ *
+ * Blocks are not copied: data points into RDRAM, where each 32-bit word
+ * holds one stereo frame (left sample in the high half). It stays valid
+ * until the game reuses its output buffer, usually a couple of frames
+ * later, so consumers are expected to keep up. */
+struct rsp_hle_audio_block
+{
+    const void* data;
+    uint32_t address;  /* RDRAM address */
+    uint32_t size;     /* in bytes */
+};
+
+typedef void (*rsp_hle_audio_tap_t)(void* context, const struct rsp_hle_audio_block* block);
+
+/* Functions exported by the plugin (hle_set_audio_tap & co. for users of
+ * the hle core library, see rsp_hle_core.h):
+ * RspHleSetAudioTap:        run callback on each block (NULL disables it)
+ * RspHleEnableAudioTapRing: start / stop queueing blocks into the ring,
+ *                           blocks being dropped when it is full
+ * RspHlePopAudioTapBlock:   take the oldest queued block, returns 0 when
+ *                           the ring is empty. Only one consumer thread
+ *                           may call it */
+typedef void (*ptr_RspHleSetAudioTap)(rsp_hle_audio_tap_t callback, void* context);
+typedef void (*ptr_RspHleEnableAudioTapRing)(int enable);
+typedef int  (*ptr_RspHlePopAudioTapBlock)(struct rsp_hle_audio_block* block);
+
+#endif
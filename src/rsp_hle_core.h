@@ -0,0 +1,135 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - rsp_hle_core.h                                  *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef RSP_HLE_CORE_H
+#define RSP_HLE_CORE_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+#include "rsp_hle_audio_tap.h"
+
+/* Public interface of the hle core (libmupen64plus-rsp-hle-core.a), for
+ * embedding it without the mupen64plus plugin API. The core executes the
+ * task found in DMEM each time hle_execute is called, and reaches back to
+ * the embedder through the callbacks below. */
+
+struct hle_t;
+
+/* Callbacks shared by all the core instances, which are told apart by the
+ * user_defined pointer given to hle_init. Any of them may be NULL: messages
+ * are then dropped, and unknown tasks are not forwarded. */
+struct hle_callbacks_t
+{
+    void (*verbose_message)(void* user_defined, const char* message, va_list args);
+    void (*info_message)(void* user_defined, const char* message, va_list args);
+    void (*error_message)(void* user_defined, const char* message, va_list args);
+    void (*warn_message)(void* user_defined, const char* message, va_list args);
+
+    void (*check_interrupts)(void* user_defined);
+    void (*process_dlist_list)(void* user_defined);
+    void (*process_alist_list)(void* user_defined);
+    void (*process_rdp_list)(void* user_defined);
+    void (*show_cfb)(void* user_defined);
+
+    /* returns 0 if the task was handled, non-zero otherwise */
+    int (*forward_task)(void* user_defined);
+};
+
+/* Audio accuracy tiers */
+enum
+{
+    /* same output as the audio ucodes running on the RSP */
+    HLE_AUDIO_BIT_EXACT = 0,
+    /* linear resampling, wide mix bus and skipped inaudible voices */
+    HLE_AUDIO_FAST = 1
+};
+
+/* RDRAM size of mupen64plus-core, which RSP_INFO does not expose */
+enum { HLE_DEFAULT_DRAM_SIZE = 0x800000 };
+
+/* Options of a core instance, see the plugin config parameters of the same
+ * names for their meaning */
+struct hle_options_t
+{
+    int hle_gfx;                    /* DisplayListToGraphicsPlugin */
+    int hle_aud;                    /* AudioListToAudioPlugin */
+    int audio_accuracy;             /* AudioAccuracy */
+    unsigned int shadow_rate;       /* ShadowValidationRate */
+    size_t adpcm_cache_size;        /* AdpcmCacheSize, in bytes */
+    int memoization;                /* AudioTaskMemoization */
+    const char* capture_filename;   /* AudioTaskCapture, NULL disables it */
+    unsigned int musyx_threads;     /* MusyXThreads, 0 and 1 being serial */
+
+    /* size of the dram buffer given to hle_init, in bytes, 0 meaning
+     * HLE_DEFAULT_DRAM_SIZE. Shadow validation, memoization and task
+     * captures copy that much of it */
+    size_t dram_size;
+};
+
+void hle_set_callbacks(const struct hle_callbacks_t* callbacks);
+
+/* allocate / free a zero-initialized core instance */
+struct hle_t* hle_create(void);
+void hle_destroy(struct hle_t* hle);
+
+/* dram must hold the dram_size bytes given by the options (by default
+ * HLE_DEFAULT_DRAM_SIZE). Ucodes mask DRAM addresses to 24 bits, so a 16MB
+ * buffer, plus the largest transfer, keeps them in bounds whatever the task */
+void hle_init(struct hle_t* hle,
+    unsigned char* dram,
+    unsigned char* dmem,
+    unsigned char* imem,
+    unsigned int* mi_intr,
+    unsigned int* sp_mem_addr,
+    unsigned int* sp_dram_addr,
+    unsigned int* sp_rd_length,
+    unsigned int* sp_wr_length,
+    unsigned int* sp_status,
+    unsigned int* sp_dma_full,
+    unsigned int* sp_dma_busy,
+    unsigned int* sp_pc,
+    unsigned int* sp_semaphore,
+    unsigned int* dpc_start,
+    unsigned int* dpc_end,
+    unsigned int* dpc_current,
+    unsigned int* dpc_status,
+    unsigned int* dpc_clock,
+    unsigned int* dpc_bufbusy,
+    unsigned int* dpc_pipebusy,
+    unsigned int* dpc_tmem,
+    void* user_defined);
+
+void hle_configure(struct hle_t* hle, const struct hle_options_t* options);
+
+const char* hle_audio_accuracy_name(int audio_accuracy);
+
+void hle_execute(struct hle_t* hle);
+
+/* log statistics and free the buffers allocated while executing tasks */
+void hle_release(struct hle_t* hle);
+
+/* audio output tap, see rsp_hle_audio_tap.h */
+void hle_set_audio_tap(struct hle_t* hle, rsp_hle_audio_tap_t callback, void* context);
+void hle_enable_audio_tap_ring(struct hle_t* hle, int enable);
+int hle_pop_audio_tap_block(struct hle_t* hle, struct rsp_hle_audio_block* block);
+
+#endif
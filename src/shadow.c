@@ -0,0 +1,257 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - shadow.c                                        *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "memory.h"
+#include "ucodes.h"
+
+/* bound the disk space used by divergent task captures */
+#define SHADOW_MAX_CAPTURES 8
+
+/* everything a task can read or modify, dram holding hle->dram_size bytes */
+struct shadow_snapshot_t {
+    uint8_t dmem[0x1000];
+    uint8_t alist_buffer[0x1000];
+    struct alist_audio_t alist_audio;
+    struct alist_naudio_t alist_naudio;
+    struct alist_nead_t alist_nead;
+    uint8_t mp3_buffer[0x1000];
+    uint8_t* dram;
+};
+
+
+/* local functions */
+static void save_snapshot(struct shadow_snapshot_t* snapshot, const struct hle_t* hle)
+{
+    memcpy(snapshot->dmem, hle->dmem, 0x1000);
+    memcpy(snapshot->alist_buffer, hle->alist_buffer, 0x1000);
+    snapshot->alist_audio = hle->alist_audio;
+    snapshot->alist_naudio = hle->alist_naudio;
+    snapshot->alist_nead = hle->alist_nead;
+    memcpy(snapshot->mp3_buffer, hle->mp3_buffer, 0x1000);
+    memcpy(snapshot->dram, hle->dram, hle->dram_size);
+}
+
+static void restore_snapshot(struct hle_t* hle, const struct shadow_snapshot_t* snapshot)
+{
+    memcpy(hle->dmem, snapshot->dmem, 0x1000);
+    memcpy(hle->alist_buffer, snapshot->alist_buffer, 0x1000);
+    hle->alist_audio = snapshot->alist_audio;
+    hle->alist_naudio = snapshot->alist_naudio;
+    hle->alist_nead = snapshot->alist_nead;
+    memcpy(hle->mp3_buffer, snapshot->mp3_buffer, 0x1000);
+    memcpy(hle->dram, snapshot->dram, hle->dram_size);
+}
+
+static long first_difference(const uint8_t* a, const uint8_t* b, size_t size)
+{
+    size_t i;
+
+    if (memcmp(a, b, size) == 0)
+        return -1;
+
+    for (i = 0; a[i] == b[i]; ++i) { }
+
+    return (long)i;
+}
+
+static struct shadow_snapshot_t* allocate_snapshot(size_t dram_size)
+{
+    struct shadow_snapshot_t* snapshot = malloc(sizeof(*snapshot));
+
+    if (snapshot == NULL)
+        return NULL;
+
+    snapshot->dram = malloc(dram_size);
+    if (snapshot->dram == NULL) {
+        free(snapshot);
+        return NULL;
+    }
+
+    return snapshot;
+}
+
+static void free_snapshot(struct shadow_snapshot_t* snapshot)
+{
+    if (snapshot != NULL)
+        free(snapshot->dram);
+
+    free(snapshot);
+}
+
+static bool allocate_snapshots(struct hle_t* hle)
+{
+    struct shadow_t* shadow = &hle->shadow;
+
+    if (shadow->input == NULL)
+        shadow->input = allocate_snapshot(hle->dram_size);
+
+    if (shadow->reference == NULL)
+        shadow->reference = allocate_snapshot(hle->dram_size);
+
+    if (shadow->input == NULL || shadow->reference == NULL) {
+        HleErrorMessage(hle->user_defined,
+                "Can't allocate shadow validation buffers, disabling validation.");
+        shadow_release(hle);
+        shadow->rate = 0;
+        return false;
+    }
+
+    return true;
+}
+
+/* Run the task with interrupts muted, so that the replay is invisible
+ * to the rest of the emulator. */
+static void run_silently(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    unsigned int* sp_status = hle->sp_status;
+    unsigned int* mi_intr = hle->mi_intr;
+    unsigned int sp_status_copy = *sp_status & ~SP_STATUS_INTR_ON_BREAK;
+    unsigned int mi_intr_copy = *mi_intr;
+
+    hle->sp_status = &sp_status_copy;
+    hle->mi_intr = &mi_intr_copy;
+
+    uc_pfunc(hle);
+
+    hle->sp_status = sp_status;
+    hle->mi_intr = mi_intr;
+}
+
+static void capture_task(struct hle_t* hle, uint32_t uc_start)
+{
+    char filename[256];
+    FILE *f;
+
+    /* layout: task input snapshot (see struct shadow_snapshot_t) up to its
+     * dram pointer, followed by the hle->dram_size bytes of DRAM */
+    sprintf(&filename[0], "shadow_%x_%u.bin", uc_start, hle->shadow.divergences);
+
+    f = fopen(filename, "wb");
+    if (f != NULL) {
+        if (fwrite(hle->shadow.input, offsetof(struct shadow_snapshot_t, dram), 1, f) != 1
+         || fwrite(hle->shadow.input->dram, hle->dram_size, 1, f) != 1)
+            HleErrorMessage(hle->user_defined, "Writing error on %s", filename);
+        fclose(f);
+    } else
+        HleErrorMessage(hle->user_defined, "Couldn't open %s for writing !", filename);
+}
+
+static void report_divergence(struct hle_t* hle, const char* memory, long offset)
+{
+    uint32_t uc_start = *dmem_u32(hle, TASK_UCODE);
+
+    ++hle->shadow.divergences;
+
+    HleWarnMessage(hle->user_defined,
+            "Shadow validation: %s divergence at %#lx (uc_start: %x, data_ptr: %x)",
+            memory, offset, uc_start, *dmem_u32(hle, TASK_DATA_PTR));
+
+    if (hle->shadow.divergences <= SHADOW_MAX_CAPTURES)
+        capture_task(hle, uc_start);
+}
+
+
+/* Global functions */
+
+/**
+ * Returns non-zero if the current task should be shadow validated.
+ **/
+int shadow_sample(struct hle_t* hle)
+{
+    struct shadow_t* shadow = &hle->shadow;
+
+    if (shadow->rate == 0)
+        return 0;
+
+    if (shadow->countdown == 0 || shadow->countdown > shadow->rate)
+        shadow->countdown = shadow->rate;
+
+    return (--shadow->countdown == 0);
+}
+
+/**
+ * Execute a task twice, first with the reference code paths and then with
+ * the optimized ones, and report any difference in DRAM and DMEM contents.
+ *
+ * The optimized run is the one whose side effects (interrupts, messages)
+ * reach the emulator.
+ **/
+void shadow_execute(struct hle_t* hle, ucode_func_t uc_pfunc)
+{
+    struct shadow_t* shadow = &hle->shadow;
+    long offset;
+
+    if (!allocate_snapshots(hle)) {
+        uc_pfunc(hle);
+        return;
+    }
+
+    save_snapshot(shadow->input, hle);
+
+    hle->reference = 1;
+    run_silently(hle, uc_pfunc);
+    hle->reference = 0;
+
+    save_snapshot(shadow->reference, hle);
+    restore_snapshot(hle, shadow->input);
+
+    uc_pfunc(hle);
+
+    ++shadow->checked;
+
+    /* compare what the task has produced */
+    if ((offset = first_difference(hle->dram, shadow->reference->dram, hle->dram_size)) >= 0)
+        report_divergence(hle, "DRAM", offset);
+    else if ((offset = first_difference(hle->dmem, shadow->reference->dmem, 0x1000)) >= 0)
+        report_divergence(hle, "DMEM", offset);
+    else if ((offset = first_difference(hle->alist_buffer, shadow->reference->alist_buffer, 0x1000)) >= 0)
+        report_divergence(hle, "audio DMEM", offset);
+}
+
+/**
+ * Log validation statistics and free shadow validation buffers.
+ **/
+void shadow_release(struct hle_t* hle)
+{
+    struct shadow_t* shadow = &hle->shadow;
+
+    if (shadow->checked != 0) {
+        HleInfoMessage(hle->user_defined,
+                "Shadow validation: %u tasks checked, %u divergences",
+                shadow->checked, shadow->divergences);
+    }
+
+    free_snapshot(shadow->input);
+    free_snapshot(shadow->reference);
+
+    shadow->input = NULL;
+    shadow->reference = NULL;
+    shadow->checked = 0;
+    shadow->divergences = 0;
+}
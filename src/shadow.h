@@ -0,0 +1,50 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - shadow.h                                        *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include "ucodes.h"
+
+struct shadow_snapshot_t;
+
+/* Shadow validation runs a sampled fraction of the audio tasks a second time
+ * using the scalar reference code paths and compares what both runs wrote
+ * into DRAM and DMEM. */
+struct shadow_t {
+    /* validate 1 task out of rate (0 disables validation) */
+    unsigned int rate;
+    unsigned int countdown;
+
+    /* statistics */
+    unsigned int checked;
+    unsigned int divergences;
+
+    /* lazily allocated task input / reference output snapshots */
+    struct shadow_snapshot_t* input;
+    struct shadow_snapshot_t* reference;
+};
+
+int shadow_sample(struct hle_t* hle);
+void shadow_execute(struct hle_t* hle, ucode_func_t uc_pfunc);
+void shadow_release(struct hle_t* hle);
+
+#endif
@@ -0,0 +1,405 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - task_capture.c                                  *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "task_capture.h"
+
+#define TASK_CAPTURE_VERSION 2
+#define TASK_CAPTURE_PAGE_SIZE 0x1000
+
+static const char capture_magic[8] = { 'R', 'S', 'P', 'H', 'L', 'E', 'C', 'P' };
+
+/* Captures are little endian whatever the host. A stream either writes or
+ * reads them, so that the capture layout is only spelled out once, and
+ * stops at the first error */
+struct capture_stream_t {
+    FILE* file;
+    bool writing;
+    bool ok;
+};
+
+
+/* local functions */
+static void open_stream(struct capture_stream_t* stream, FILE* file, bool writing)
+{
+    stream->file = file;
+    stream->writing = writing;
+    stream->ok = true;
+}
+
+static void io_u32(struct capture_stream_t* stream, uint32_t* value)
+{
+    uint8_t bytes[4];
+
+    if (!stream->ok)
+        return;
+
+    if (stream->writing) {
+        bytes[0] = (uint8_t)(*value);
+        bytes[1] = (uint8_t)(*value >> 8);
+        bytes[2] = (uint8_t)(*value >> 16);
+        bytes[3] = (uint8_t)(*value >> 24);
+        stream->ok = fwrite(bytes, sizeof(bytes), 1, stream->file) == 1;
+    }
+    else if (fread(bytes, sizeof(bytes), 1, stream->file) == 1) {
+        *value = (uint32_t)bytes[0]
+               | ((uint32_t)bytes[1] << 8)
+               | ((uint32_t)bytes[2] << 16)
+               | ((uint32_t)bytes[3] << 24);
+    }
+    else
+        stream->ok = false;
+}
+
+static void io_u16(struct capture_stream_t* stream, uint16_t* value)
+{
+    uint32_t word = *value;
+
+    io_u32(stream, &word);
+    *value = (uint16_t)word;
+}
+
+static void io_u32s(struct capture_stream_t* stream, uint32_t* values, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        io_u32(stream, &values[i]);
+}
+
+static void io_u16s(struct capture_stream_t* stream, uint16_t* values, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+        io_u16(stream, &values[i]);
+}
+
+/* RDRAM, DMEM and the ucodes buffers are arrays of host order words */
+static void io_words(struct capture_stream_t* stream, void* buffer, size_t size)
+{
+#ifdef M64P_BIG_ENDIAN
+    uint8_t* bytes = buffer;
+    uint32_t word;
+    size_t i;
+
+    for (i = 0; i < size; i += 4) {
+        memcpy(&word, bytes + i, 4);
+        io_u32(stream, &word);
+        memcpy(bytes + i, &word, 4);
+    }
+#else
+    if (!stream->ok)
+        return;
+
+    stream->ok = stream->writing
+        ? fwrite(buffer, size, 1, stream->file) == 1
+        : fread(buffer, size, 1, stream->file) == 1;
+#endif
+}
+
+/* audio ucodes state carried over from one task to the next. Predictor
+ * matrices are left out, they get rebuilt from the tables */
+static void io_state(struct capture_stream_t* stream, struct hle_t* hle)
+{
+    struct alist_audio_t* audio = &hle->alist_audio;
+    struct alist_naudio_t* naudio = &hle->alist_naudio;
+    struct alist_nead_t* nead = &hle->alist_nead;
+
+    io_words(stream, hle->alist_buffer, sizeof(hle->alist_buffer));
+
+    io_u32s(stream, audio->segments, N_SEGMENTS);
+    io_u16(stream, &audio->in);
+    io_u16(stream, &audio->out);
+    io_u16(stream, &audio->count);
+    io_u16(stream, &audio->dry_right);
+    io_u16(stream, &audio->wet_left);
+    io_u16(stream, &audio->wet_right);
+    io_u16(stream, (uint16_t*)&audio->dry);
+    io_u16(stream, (uint16_t*)&audio->wet);
+    io_u16s(stream, (uint16_t*)audio->vol, 2);
+    io_u16s(stream, (uint16_t*)audio->target, 2);
+    io_u32s(stream, (uint32_t*)audio->rate, 2);
+    io_u32(stream, &audio->loop);
+    io_u16s(stream, (uint16_t*)audio->table, 16 * 8);
+
+    io_u16(stream, (uint16_t*)&naudio->dry);
+    io_u16(stream, (uint16_t*)&naudio->wet);
+    io_u16s(stream, (uint16_t*)naudio->vol, 2);
+    io_u16s(stream, (uint16_t*)naudio->target, 2);
+    io_u32s(stream, (uint32_t*)naudio->rate, 2);
+    io_u32(stream, &naudio->loop);
+    io_u16s(stream, (uint16_t*)naudio->table, 16 * 8);
+
+    io_u16(stream, &nead->in);
+    io_u16(stream, &nead->out);
+    io_u16(stream, &nead->count);
+    io_u16s(stream, nead->env_values, 3);
+    io_u16s(stream, nead->env_steps, 3);
+    io_u32(stream, &nead->loop);
+    io_u16s(stream, (uint16_t*)nead->table, 16 * 8);
+    io_u16(stream, &nead->filter_count);
+    io_u32s(stream, nead->filter_lut_address, 2);
+
+    io_words(stream, hle->mp3_buffer, sizeof(hle->mp3_buffer));
+
+    if (!stream->writing) {
+        adpcm_predictor_invalidate(&audio->predictor);
+        adpcm_predictor_invalidate(&naudio->predictor);
+        adpcm_predictor_invalidate(&nead->predictor);
+    }
+}
+
+static uint32_t page_count(uint32_t dram_size)
+{
+    return (dram_size + TASK_CAPTURE_PAGE_SIZE - 1) / TASK_CAPTURE_PAGE_SIZE;
+}
+
+/* the last page may be a partial one */
+static size_t page_size(uint32_t dram_size, uint32_t page)
+{
+    size_t offset = (size_t)page * TASK_CAPTURE_PAGE_SIZE;
+
+    return (dram_size - offset < TASK_CAPTURE_PAGE_SIZE)
+        ? dram_size - offset
+        : TASK_CAPTURE_PAGE_SIZE;
+}
+
+/* layout: magic, version, RDRAM size, RDRAM, then the ucodes state */
+static bool write_header(struct hle_t* hle)
+{
+    struct capture_stream_t stream;
+    uint32_t version = TASK_CAPTURE_VERSION;
+
+    open_stream(&stream, hle->capture.file, true);
+    stream.ok = fwrite(capture_magic, sizeof(capture_magic), 1, stream.file) == 1;
+    io_u32(&stream, &version);
+    io_u32(&stream, &hle->capture.dram_size);
+    io_words(&stream, hle->dram, hle->capture.dram_size);
+    io_state(&stream, hle);
+
+    return stream.ok;
+}
+
+/* layout: page count, (page index, page contents) for each modified page,
+ * then DMEM */
+static bool write_task(struct hle_t* hle)
+{
+    struct task_capture_t* capture = &hle->capture;
+    struct capture_stream_t stream;
+    uint32_t* pages = capture->pages;
+    uint32_t count = 0;
+    uint32_t page;
+    uint32_t i;
+
+    for (page = 0; page < page_count(capture->dram_size); ++page) {
+        size_t offset = (size_t)page * TASK_CAPTURE_PAGE_SIZE;
+        size_t size = page_size(capture->dram_size, page);
+
+        if (memcmp(capture->dram + offset, hle->dram + offset, size) != 0) {
+            memcpy(capture->dram + offset, hle->dram + offset, size);
+            pages[count++] = page;
+        }
+    }
+
+    open_stream(&stream, capture->file, true);
+    io_u32(&stream, &count);
+
+    for (i = 0; i < count; ++i) {
+        io_u32(&stream, &pages[i]);
+        io_words(&stream, hle->dram + (size_t)pages[i] * TASK_CAPTURE_PAGE_SIZE,
+                 page_size(capture->dram_size, pages[i]));
+    }
+
+    io_words(&stream, hle->dmem, 0x1000);
+
+    return stream.ok;
+}
+
+static int read_error(struct hle_t* hle)
+{
+    HleErrorMessage(hle->user_defined, "Task capture: truncated or corrupted capture");
+    return -1;
+}
+
+
+/* Global functions */
+int task_capture_open(struct hle_t* hle, const char* filename)
+{
+    struct task_capture_t* capture = &hle->capture;
+    char* path;
+
+    task_capture_release(hle);
+
+    /* filename, then filename.2, filename.3, ... */
+    path = malloc(strlen(filename) + 12);
+    if (path == NULL) {
+        HleErrorMessage(hle->user_defined, "Can't allocate task capture filename.");
+        return 0;
+    }
+
+    if (capture->sessions == 0)
+        strcpy(path, filename);
+    else
+        sprintf(path, "%s.%u", filename, capture->sessions + 1);
+
+    ++capture->sessions;
+
+    capture->file = fopen(path, "wb");
+    if (capture->file == NULL) {
+        HleErrorMessage(hle->user_defined, "Couldn't open %s for writing !", path);
+        free(path);
+        return 0;
+    }
+
+    HleInfoMessage(hle->user_defined, "Task capture: writing to %s", path);
+    free(path);
+    return 1;
+}
+
+/**
+ * Append the task about to be executed to the capture. The header is
+ * written along with the first task, once RDRAM holds the game.
+ **/
+void task_capture_task(struct hle_t* hle)
+{
+    struct task_capture_t* capture = &hle->capture;
+    bool written = true;
+
+    if (capture->dram == NULL) {
+        /* RDRAM gets written as whole words */
+        capture->dram_size = (uint32_t)hle->dram_size & ~UINT32_C(3);
+        capture->dram = malloc(capture->dram_size);
+        capture->pages = malloc(page_count(capture->dram_size) * sizeof(capture->pages[0]));
+        if (capture->dram == NULL || capture->pages == NULL) {
+            HleErrorMessage(hle->user_defined,
+                    "Can't allocate task capture buffer, disabling capture.");
+            task_capture_release(hle);
+            return;
+        }
+
+        memcpy(capture->dram, hle->dram, capture->dram_size);
+        written = write_header(hle);
+    }
+
+    if (!written || !write_task(hle)) {
+        HleErrorMessage(hle->user_defined, "Task capture: writing error, disabling capture.");
+        task_capture_release(hle);
+        return;
+    }
+
+    ++capture->tasks;
+}
+
+void task_capture_release(struct hle_t* hle)
+{
+    struct task_capture_t* capture = &hle->capture;
+
+    if (capture->tasks != 0)
+        HleInfoMessage(hle->user_defined, "Task capture: %u tasks captured", capture->tasks);
+
+    if (capture->file != NULL)
+        fclose(capture->file);
+
+    free(capture->dram);
+    free(capture->pages);
+
+    capture->file = NULL;
+    capture->dram = NULL;
+    capture->pages = NULL;
+    capture->tasks = 0;
+}
+
+int task_capture_read_header(struct hle_t* hle, FILE* file)
+{
+    struct capture_stream_t stream;
+    char magic[sizeof(capture_magic)];
+    uint32_t version = 0;
+    uint32_t dram_size = 0;
+
+    open_stream(&stream, file, false);
+    stream.ok = fread(magic, sizeof(magic), 1, file) == 1
+             && memcmp(magic, capture_magic, sizeof(magic)) == 0;
+    io_u32(&stream, &version);
+    io_u32(&stream, &dram_size);
+
+    if (!stream.ok) {
+        HleErrorMessage(hle->user_defined, "Task capture: not a capture file");
+        return -1;
+    }
+
+    if (version != TASK_CAPTURE_VERSION || (dram_size & 3) != 0) {
+        HleErrorMessage(hle->user_defined,
+                "Task capture: incompatible capture (version %u)", version);
+        return -1;
+    }
+
+    if (dram_size > hle->dram_size) {
+        HleErrorMessage(hle->user_defined,
+                "Task capture: %u bytes of RDRAM do not fit in %u", dram_size,
+                (unsigned int)hle->dram_size);
+        return -1;
+    }
+
+    hle->capture.dram_size = dram_size;
+
+    io_words(&stream, hle->dram, dram_size);
+    io_state(&stream, hle);
+
+    return stream.ok ? 1 : read_error(hle);
+}
+
+int task_capture_read_task(struct hle_t* hle, FILE* file)
+{
+    struct capture_stream_t stream;
+    uint32_t count = 0;
+    uint32_t page = 0;
+    uint32_t i;
+
+    open_stream(&stream, file, false);
+    io_u32(&stream, &count);
+    if (!stream.ok)
+        return feof(file) ? 0 : read_error(hle);
+
+    if (count > page_count(hle->capture.dram_size))
+        return read_error(hle);
+
+    for (i = 0; i < count; ++i) {
+        io_u32(&stream, &page);
+        if (!stream.ok || page >= page_count(hle->capture.dram_size))
+            return read_error(hle);
+
+        io_words(&stream, hle->dram + (size_t)page * TASK_CAPTURE_PAGE_SIZE,
+                 page_size(hle->capture.dram_size, page));
+    }
+
+    io_words(&stream, hle->dmem, 0x1000);
+
+    return stream.ok ? 1 : read_error(hle);
+}
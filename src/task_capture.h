@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - task_capture.h                                  *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TASK_CAPTURE_H
+#define TASK_CAPTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct hle_t;
+
+/* Task captures record the stream of audio tasks run by the core, so that
+ * they can be rendered again offline without emulating the rest of the
+ * console (see tools/rsp_hle_render.c).
+ *
+ * A capture starts with the RDRAM contents and the audio ucodes state at
+ * the first captured task, followed by one record per task holding the
+ * RDRAM pages modified since the previous task and the task DMEM. */
+struct task_capture_t {
+    FILE* file;
+
+    /* RDRAM size of the capture being written or read */
+    uint32_t dram_size;
+
+    /* RDRAM contents as of the last captured task, and the pages modified
+     * by the next one */
+    uint8_t* dram;
+    uint32_t* pages;
+
+    unsigned int tasks;
+
+    /* captures opened so far: each one after the first goes to its own
+     * file, suffixed with its number, so that a session does not
+     * overwrite the capture of the previous one */
+    unsigned int sessions;
+};
+
+/* writing side: open the capture file, then capture each task before it
+ * gets executed */
+int task_capture_open(struct hle_t* hle, const char* filename);
+void task_capture_task(struct hle_t* hle);
+void task_capture_release(struct hle_t* hle);
+
+/* reading side: the header fills RDRAM (hle->dram_size bytes being enough
+ * for the captured ones) and the ucodes state, then each record readies the
+ * next task. Both return 1 on success, 0 at the end of the capture and -1
+ * on error */
+int task_capture_read_header(struct hle_t* hle, FILE* file);
+int task_capture_read_task(struct hle_t* hle, FILE* file);
+
+#endif
@@ -24,6 +24,8 @@
 
 #include <stdint.h>
 
+#include "audio.h"
+
 #define CACHED_UCODES_MAX_SIZE 16
 
 struct hle_t;
@@ -74,6 +76,9 @@ struct alist_audio_t {
     /* ADPCM loop point address */
     uint32_t loop;
 
+    /* predictor matrices of the ADPCM table */
+    struct adpcm_predictor_t predictor;
+
     /* storage for ADPCM table and polef coefficients */
     int16_t table[16 * 8];
 };
@@ -97,6 +102,9 @@ struct alist_naudio_t {
     /* ADPCM loop point address */
     uint32_t loop;
 
+    /* predictor matrices of the ADPCM table */
+    struct adpcm_predictor_t predictor;
+
     /* storage for ADPCM table and polef coefficients */
     int16_t table[16 * 8];
 };
@@ -122,6 +130,9 @@ struct alist_nead_t {
     /* ADPCM loop point address */
     uint32_t loop;
 
+    /* predictor matrices of the ADPCM table */
+    struct adpcm_predictor_t predictor;
+
     /* storage for ADPCM table and polef coefficients */
     int16_t table[16 * 8];
 
@@ -149,6 +160,25 @@ void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address);
 
 
 /* musyx ucodes */
+enum { MUSYX_CODEBOOK_SLOTS = 8 };
+
+/* ADPCM table of voices, as loaded from DRAM */
+struct musyx_codebook_t {
+    uint32_t address;
+    uint8_t valid;
+
+    /* table bytes as they lie in DRAM, to check that it is unchanged */
+    uint8_t raw[16 * 8 * 2];
+
+    int16_t table[16 * 8];
+    struct adpcm_predictor_t predictor;
+};
+
+/* direct mapped cache of the ADPCM tables, which voices share a few of */
+struct musyx_codebooks_t {
+    struct musyx_codebook_t slots[MUSYX_CODEBOOK_SLOTS];
+};
+
 void musyx_v1_task(struct hle_t* hle);
 void musyx_v2_task(struct hle_t* hle);
 
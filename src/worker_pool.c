@@ -0,0 +1,178 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - worker_pool.c                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "osal_thread.h"
+#include "worker_pool.h"
+
+struct worker_pool_t
+{
+    /* guards the batch and exiting */
+    struct osal_mutex_t* mutex;
+    /* signaled when a batch starts or the pool exits */
+    struct osal_cond_t* work;
+    /* signaled when the last job of a batch completes */
+    struct osal_cond_t* done;
+
+    /* see worker_pool_lock */
+    struct osal_mutex_t* shared;
+
+    struct osal_thread_t** threads;
+    unsigned int thread_count;
+
+    /* current batch: jobs [next, count) are yet to start
+     * and pending of them are yet to complete */
+    worker_pool_job_t job;
+    void* opaque;
+    unsigned int count;
+    unsigned int next;
+    unsigned int pending;
+
+    bool exiting;
+};
+
+/* run jobs of the current batch until there is none left to start.
+ * Called and returns with the mutex held */
+static void run_jobs(struct worker_pool_t* pool)
+{
+    while (pool->next < pool->count) {
+        unsigned int index = pool->next++;
+
+        osal_mutex_unlock(pool->mutex);
+        pool->job(pool->opaque, index);
+        osal_mutex_lock(pool->mutex);
+
+        if (--pool->pending == 0)
+            osal_cond_broadcast(pool->done);
+    }
+}
+
+static void worker_main(void* arg)
+{
+    struct worker_pool_t* pool = (struct worker_pool_t*)arg;
+
+    osal_mutex_lock(pool->mutex);
+
+    while (!pool->exiting) {
+        if (pool->next < pool->count)
+            run_jobs(pool);
+        else
+            osal_cond_wait(pool->work, pool->mutex);
+    }
+
+    osal_mutex_unlock(pool->mutex);
+}
+
+struct worker_pool_t* worker_pool_create(unsigned int workers)
+{
+    struct worker_pool_t* pool = calloc(1, sizeof(*pool));
+
+    if (pool == NULL)
+        return NULL;
+
+    pool->mutex   = osal_mutex_create();
+    pool->work    = osal_cond_create();
+    pool->done    = osal_cond_create();
+    pool->shared  = osal_mutex_create();
+    pool->threads = calloc(workers, sizeof(pool->threads[0]));
+
+    if (pool->mutex == NULL || pool->work == NULL || pool->done == NULL
+     || pool->shared == NULL || pool->threads == NULL) {
+        worker_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (; pool->thread_count < workers; ++pool->thread_count) {
+        pool->threads[pool->thread_count] = osal_thread_create(worker_main, pool);
+
+        if (pool->threads[pool->thread_count] == NULL) {
+            worker_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void worker_pool_destroy(struct worker_pool_t* pool)
+{
+    unsigned int i;
+
+    if (pool == NULL)
+        return;
+
+    if (pool->thread_count != 0) {
+        osal_mutex_lock(pool->mutex);
+        pool->exiting = true;
+        osal_cond_broadcast(pool->work);
+        osal_mutex_unlock(pool->mutex);
+
+        for (i = 0; i < pool->thread_count; ++i)
+            osal_thread_join(pool->threads[i]);
+    }
+
+    if (pool->shared != NULL)
+        osal_mutex_destroy(pool->shared);
+    if (pool->done != NULL)
+        osal_cond_destroy(pool->done);
+    if (pool->work != NULL)
+        osal_cond_destroy(pool->work);
+    if (pool->mutex != NULL)
+        osal_mutex_destroy(pool->mutex);
+
+    free(pool->threads);
+    free(pool);
+}
+
+void worker_pool_run(struct worker_pool_t* pool, worker_pool_job_t job,
+                     void* opaque, unsigned int count)
+{
+    if (count == 0)
+        return;
+
+    osal_mutex_lock(pool->mutex);
+
+    pool->job = job;
+    pool->opaque = opaque;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    osal_cond_broadcast(pool->work);
+
+    run_jobs(pool);
+
+    while (pool->pending != 0)
+        osal_cond_wait(pool->done, pool->mutex);
+
+    osal_mutex_unlock(pool->mutex);
+}
+
+void worker_pool_lock(struct worker_pool_t* pool)
+{
+    osal_mutex_lock(pool->shared);
+}
+
+void worker_pool_unlock(struct worker_pool_t* pool)
+{
+    osal_mutex_unlock(pool->shared);
+}
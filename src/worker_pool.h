@@ -0,0 +1,44 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - worker_pool.h                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+struct worker_pool_t;
+
+typedef void (*worker_pool_job_t)(void* opaque, unsigned int index);
+
+/* Pool of threads running batches of independent jobs. The thread running
+ * a batch takes part in it, so a pool of n workers runs n + 1 jobs at once.
+ * Jobs run outside of the core thread: they must not call back into the
+ * core (HleVerboseMessage and friends) */
+struct worker_pool_t* worker_pool_create(unsigned int workers);
+void worker_pool_destroy(struct worker_pool_t* pool);
+
+/* run job(opaque, i) for i in [0, count) and return once all of them ran */
+void worker_pool_run(struct worker_pool_t* pool, worker_pool_job_t job,
+                     void* opaque, unsigned int count);
+
+/* lock shared by the jobs, for the state they cannot keep private */
+void worker_pool_lock(struct worker_pool_t* pool);
+void worker_pool_unlock(struct worker_pool_t* pool);
+
+#endif
@@ -0,0 +1,376 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - rsp_hle_render.c                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64Plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Offline renderer of audio task captures (see src/task_capture.h).
+ * Captures are replayed through the hle core, without emulating the rest of
+ * the console, and the audio they produce is written to <capture>.wav */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rsp_hle_core.h"
+#include "task_capture.h"
+
+/* ucodes mask RDRAM addresses to 24 bits, leave some room for the
+ * accesses running past the end */
+#define RENDER_DRAM_SIZE (0x1000000 + 0x10000)
+
+struct render_job_t {
+    const char* capture;
+    char* output;
+
+    FILE* wav;
+    uint32_t frames;
+    unsigned int tasks;
+    int failed;
+};
+
+/* memories and registers of the emulated RSP */
+struct render_rsp_t {
+    uint8_t dmem[0x1000];
+    uint8_t imem[0x1000];
+    unsigned int regs[18];
+};
+
+static unsigned int l_SampleRate = 32000;
+static int l_AudioAccuracy = HLE_AUDIO_BIT_EXACT;
+static int l_Verbose = 0;
+
+static struct render_job_t* l_Jobs = NULL;
+static int l_JobCount = 0;
+static int l_NextJob = 0;
+static pthread_mutex_t l_JobLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* local functions */
+static void print_message(void* user_defined, const char* level, const char* message, va_list args)
+{
+    const struct render_job_t* job = user_defined;
+    char buffer[1024];
+
+    vsnprintf(buffer, sizeof(buffer), message, args);
+    fprintf(stderr, "%s: %s: %s\n", (job != NULL) ? job->capture : "render", level, buffer);
+}
+
+static void put_u16(uint8_t* dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t* dst, uint32_t value)
+{
+    put_u16(dst, (uint16_t)value);
+    put_u16(dst + 2, (uint16_t)(value >> 16));
+}
+
+/* 16-bit stereo PCM */
+static int write_wav_header(FILE* wav, uint32_t frames)
+{
+    uint8_t header[44];
+
+    memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + frames * 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, 1);
+    put_u16(header + 22, 2);
+    put_u32(header + 24, l_SampleRate);
+    put_u32(header + 28, l_SampleRate * 4);
+    put_u16(header + 32, 4);
+    put_u16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 40, frames * 4);
+
+    return fseek(wav, 0, SEEK_SET) == 0
+        && fwrite(header, sizeof(header), 1, wav) == 1;
+}
+
+/* each 32-bit word of a block is a stereo frame, left in the high half */
+static void on_audio_block(void* context, const struct rsp_hle_audio_block* block)
+{
+    struct render_job_t* job = context;
+    const uint32_t* src = block->data;
+    size_t count = block->size / 4;
+    uint8_t samples[4 * 256];
+
+    while (count != 0 && !job->failed) {
+        size_t n = (count < 256) ? count : 256;
+        size_t i;
+
+        for (i = 0; i < n; ++i) {
+            put_u16(samples + 4 * i, (uint16_t)(src[i] >> 16));
+            put_u16(samples + 4 * i + 2, (uint16_t)src[i]);
+        }
+
+        if (fwrite(samples, 4, n, job->wav) != n) {
+            fprintf(stderr, "%s: error: writing error on %s\n", job->capture, job->output);
+            job->failed = 1;
+        }
+
+        job->frames += (uint32_t)n;
+        src += n;
+        count -= n;
+    }
+}
+
+static void render(struct render_job_t* job)
+{
+    struct hle_t* hle = hle_create();
+    struct render_rsp_t* rsp = calloc(1, sizeof(*rsp));
+    uint8_t* dram = calloc(1, RENDER_DRAM_SIZE);
+    FILE* capture = fopen(job->capture, "rb");
+    struct hle_options_t options;
+    unsigned int* regs;
+    int status = -1;
+
+    if (hle == NULL || rsp == NULL || dram == NULL) {
+        fprintf(stderr, "%s: error: out of memory\n", job->capture);
+        goto out;
+    }
+
+    if (capture == NULL) {
+        fprintf(stderr, "%s: error: couldn't open %s\n", job->capture, job->capture);
+        goto out;
+    }
+
+    job->wav = fopen(job->output, "wb");
+    if (job->wav == NULL) {
+        fprintf(stderr, "%s: error: couldn't open %s\n", job->capture, job->output);
+        goto out;
+    }
+
+    regs = rsp->regs;
+    hle_init(hle, dram, rsp->dmem, rsp->imem,
+             &regs[0], &regs[1], &regs[2], &regs[3], &regs[4], &regs[5], &regs[6],
+             &regs[7], &regs[8], &regs[9], &regs[10], &regs[11], &regs[12], &regs[13],
+             &regs[14], &regs[15], &regs[16], &regs[17],
+             job);
+
+    memset(&options, 0, sizeof(options));
+    options.audio_accuracy = l_AudioAccuracy;
+    options.dram_size = RENDER_DRAM_SIZE;
+    hle_configure(hle, &options);
+    hle_set_audio_tap(hle, on_audio_block, job);
+
+    if (!write_wav_header(job->wav, 0)) {
+        fprintf(stderr, "%s: error: writing error on %s\n", job->capture, job->output);
+        goto out;
+    }
+
+    status = task_capture_read_header(hle, capture);
+    while (status == 1 && !job->failed) {
+        status = task_capture_read_task(hle, capture);
+        if (status == 1) {
+            hle_execute(hle);
+            ++job->tasks;
+        }
+    }
+
+    if (!write_wav_header(job->wav, job->frames))
+        job->failed = 1;
+
+out:
+    if (status < 0)
+        job->failed = 1;
+
+    if (job->wav != NULL && fclose(job->wav) != 0)
+        job->failed = 1;
+    if (capture != NULL)
+        fclose(capture);
+
+    hle_destroy(hle);
+    free(dram);
+    free(rsp);
+}
+
+static void* render_worker(void* arg)
+{
+    (void)arg;
+
+    for (;;) {
+        int job;
+
+        pthread_mutex_lock(&l_JobLock);
+        job = l_NextJob++;
+        pthread_mutex_unlock(&l_JobLock);
+
+        if (job >= l_JobCount)
+            return NULL;
+
+        render(&l_Jobs[job]);
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [-f] [-j threads] [-r rate] [-v] capture...\n"
+            "  -f          use the fast audio accuracy tier\n"
+            "  -j threads  render that many captures in parallel (default: 1)\n"
+            "  -r rate     sample rate of the WAV files (default: 32000),\n"
+            "              captures do not record the AI rate\n"
+            "  -v          show verbose messages of the hle core\n",
+            program);
+}
+
+
+static void verbose_message(void* user_defined, const char *message, va_list args)
+{
+    if (l_Verbose)
+        print_message(user_defined, "verbose", message, args);
+}
+
+static void info_message(void* user_defined, const char *message, va_list args)
+{
+    if (l_Verbose)
+        print_message(user_defined, "info", message, args);
+}
+
+static void error_message(void* user_defined, const char *message, va_list args)
+{
+    print_message(user_defined, "error", message, args);
+}
+
+static void warn_message(void* user_defined, const char *message, va_list args)
+{
+    print_message(user_defined, "warning", message, args);
+}
+
+/* the renderer has neither interrupts to raise, nor other plugins or
+ * fallback RSP to hand tasks over to */
+static const struct hle_callbacks_t l_HleCallbacks =
+{
+    verbose_message,
+    info_message,
+    error_message,
+    warn_message,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+
+int main(int argc, char** argv)
+{
+    pthread_t* threads;
+    int thread_count = 1;
+    unsigned int tasks = 0;
+    double frames = 0.0;
+    double start, elapsed;
+    int failed = 0;
+    int option;
+    int i;
+
+    while ((option = getopt(argc, argv, "fj:r:vh")) != -1) {
+        switch (option) {
+        case 'f': l_AudioAccuracy = HLE_AUDIO_FAST; break;
+        case 'j': thread_count = atoi(optarg); break;
+        case 'r': l_SampleRate = (unsigned int)atoi(optarg); break;
+        case 'v': l_Verbose = 1; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (optind >= argc || thread_count <= 0 || l_SampleRate == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    l_JobCount = argc - optind;
+    l_Jobs = calloc(l_JobCount, sizeof(*l_Jobs));
+    if (thread_count > l_JobCount)
+        thread_count = l_JobCount;
+    threads = calloc(thread_count, sizeof(*threads));
+
+    if (l_Jobs == NULL || threads == NULL) {
+        fprintf(stderr, "render: error: out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < l_JobCount; ++i) {
+        const char* capture = argv[optind + i];
+
+        l_Jobs[i].capture = capture;
+        l_Jobs[i].output = malloc(strlen(capture) + sizeof(".wav"));
+        if (l_Jobs[i].output == NULL) {
+            fprintf(stderr, "render: error: out of memory\n");
+            return 1;
+        }
+        sprintf(l_Jobs[i].output, "%s.wav", capture);
+    }
+
+    hle_set_callbacks(&l_HleCallbacks);
+
+    start = now();
+
+    for (i = 1; i < thread_count; ++i) {
+        if (pthread_create(&threads[i], NULL, render_worker, NULL) != 0) {
+            fprintf(stderr, "render: error: couldn't start thread %d\n", i);
+            thread_count = i;
+            break;
+        }
+    }
+
+    render_worker(NULL);
+
+    for (i = 1; i < thread_count; ++i)
+        pthread_join(threads[i], NULL);
+
+    elapsed = now() - start;
+
+    for (i = 0; i < l_JobCount; ++i) {
+        const struct render_job_t* job = &l_Jobs[i];
+
+        printf("%s: %u tasks, %.2f s of audio%s\n", job->output, job->tasks,
+               (double)job->frames / l_SampleRate, job->failed ? " (failed)" : "");
+
+        tasks += job->tasks;
+        frames += job->frames;
+        failed |= job->failed;
+        free(job->output);
+    }
+
+    printf("%u tasks rendered in %.3f s (%.0f tasks/s, %.1fx real time)\n",
+           tasks, elapsed, tasks / elapsed, frames / l_SampleRate / elapsed);
+
+    free(threads);
+    free(l_Jobs);
+
+    return failed ? 1 : 0;
+}